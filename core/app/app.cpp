@@ -39,6 +39,7 @@ fn app_init(App_Desc ds) -> bool {
     }
     
     io_audio_init();
+    jobs_init();
     
 #if defined(GAME_DEBUG) && defined(GAME_GL)
     glEnable(GL_DEBUG_OUTPUT);
@@ -59,6 +60,7 @@ fn app_done() -> void {
     }
 
     io_audio_init();
+    jobs_done();
     imgui_done();
     os_window_done();
     os_input_done();
@@ -74,6 +76,7 @@ fn app_running() -> bool {
         }
     };
 
+    arena_reset(frame_arena());
     os_poll_events();
     os_time_step();
 
@@ -4,6 +4,7 @@
 #include "os_window.h"
 #include "os_input.h"
 #include "os_core.h"
+#include "base_jobs.h"
 
 #ifdef GAME_GL
 # include "os_gl.h"
@@ -20,8 +20,13 @@ enum class Data_Type : u8
     Float, Float2, Float3, Float4,
     Mat3, Mat4,
     Int, Int2, Int3, Int4,
-    Sampler2D,
-    Bool
+    Sampler2D, Sampler2DArray,
+    Bool,
+    // @Note: Packed vertex formats. The shaders read them as floats (vec2, vec4...), see is_normalized_type.
+    Half2, Half4,    // 16 bit floats.
+    UNorm8x4,        // [0, 255] -> [0, 1], colors.
+    SNorm16x2, SNorm16x4, // [-32767, 32767] -> [-1, 1].
+    SNorm1010102,    // x, y, z 10 bits + w 2 bits -> [-1, 1], normals.
 };
 
 inline fn is_integer_type(Data_Type type) -> bool {
@@ -32,9 +37,16 @@ inline fn is_integer_type(Data_Type type) -> bool {
         case Data_Type::Float4:
         case Data_Type::Mat3:
         case Data_Type::Mat4:
+        case Data_Type::Half2:
+        case Data_Type::Half4:
+        case Data_Type::UNorm8x4:
+        case Data_Type::SNorm16x2:
+        case Data_Type::SNorm16x4:
+        case Data_Type::SNorm1010102:
             return false;
         case Data_Type::Int:       
         case Data_Type::Sampler2D:
+        case Data_Type::Sampler2DArray:
         case Data_Type::Int2:    
         case Data_Type::Int3:  
         case Data_Type::Int4: 
@@ -45,6 +57,19 @@ inline fn is_integer_type(Data_Type type) -> bool {
     return false;
 }
 
+// @Note: Integer data the gpu converts to [0, 1] or [-1, 1] floats when reading the attribute.
+inline fn is_normalized_type(Data_Type type) -> bool {
+    switch(type) {
+        case Data_Type::UNorm8x4:
+        case Data_Type::SNorm16x2:
+        case Data_Type::SNorm16x4:
+        case Data_Type::SNorm1010102:
+            return true;
+        default:
+            return false;
+    }
+}
+
 // @Note: Returns the size in bytes.
 inline fn get_size(Data_Type type) -> u32 {
     switch(type) {
@@ -56,10 +81,17 @@ inline fn get_size(Data_Type type) -> u32 {
         case Data_Type::Mat4      : return 4 * 4 * 4;
         case Data_Type::Int       : return 4;
         case Data_Type::Sampler2D : return 32;
+        case Data_Type::Sampler2DArray : return 32;
         case Data_Type::Int2      : return 4 * 2;
         case Data_Type::Int3      : return 4 * 3;
         case Data_Type::Int4      : return 4 * 4;
         case Data_Type::Bool      : return 1;
+        case Data_Type::Half2     : return 2 * 2;
+        case Data_Type::Half4     : return 2 * 4;
+        case Data_Type::UNorm8x4  : return 4;
+        case Data_Type::SNorm16x2 : return 2 * 2;
+        case Data_Type::SNorm16x4 : return 2 * 4;
+        case Data_Type::SNorm1010102 : return 4;
         case Data_Type::None      : return 0;
     }
     return 0;
@@ -76,15 +108,32 @@ inline fn get_count(Data_Type type) -> u32 {
         case Data_Type::Mat4      : return 4 * 4;
         case Data_Type::Int       : return 1;
         case Data_Type::Sampler2D : return 32;
+        case Data_Type::Sampler2DArray : return 32;
         case Data_Type::Int2      : return 2;
         case Data_Type::Int3      : return 3;
         case Data_Type::Int4      : return 4;
         case Data_Type::Bool      : return 1;
+        case Data_Type::Half2     : return 2;
+        case Data_Type::Half4     : return 4;
+        case Data_Type::UNorm8x4  : return 4;
+        case Data_Type::SNorm16x2 : return 2;
+        case Data_Type::SNorm16x4 : return 4;
+        case Data_Type::SNorm1010102 : return 4;
         case Data_Type::None      : return 0;
     }
     return 0;
 }
 
+// @Note: FNV-1a string hash. It's constexpr, so hash_str("literal") costs nothing at runtime.
+// Pass a previous hash to chain several strings.
+constexpr fn hash_str(std::string_view str, u64 hash = 14695981039346656037ull) -> u64 {
+    for (char c : str) {
+        hash ^= (u8) c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
 // @Note: Simple log macro implementation.
 
 #ifdef GAME_DEBUG
@@ -0,0 +1,64 @@
+#include "base_allocator.h"
+#include <stdlib.h>
+
+static constexpr u64 heap_align = 16;
+
+static fn heap_alloc(Allocator*, u64 size, u64 align) -> void* {
+    (void) align; // Only read by the check, which is gone in release.
+    checkf(align <= heap_align, "Error! The heap only aligns up to %llu bytes!", heap_align);
+    void* data = malloc(size);
+    checkf(data, "Error! Out of memory! (%llu bytes)", size);
+    return data;
+}
+
+static fn heap_realloc(Allocator*, void* data, u64, u64 size, u64 align) -> void* {
+    (void) align;
+    checkf(align <= heap_align, "Error! The heap only aligns up to %llu bytes!", heap_align);
+    void* moved = realloc(data, size);
+    checkf(moved, "Error! Out of memory! (%llu bytes)", size);
+    return moved;
+}
+
+static fn heap_free(Allocator*, void* data, u64) -> void {
+    free(data);
+}
+
+fn heap_allocator() -> Allocator* {
+    static Allocator g_heap = { heap_alloc, nullptr, heap_realloc, heap_free };
+    return &g_heap;
+}
+
+fn mem_alloc(Allocator* allocator, u64 size, u64 align) -> void* {
+    allocator = allocator ? allocator : heap_allocator();
+    return allocator->alloc_fn(allocator, size, align);
+}
+
+fn mem_resize(Allocator* allocator, void* data, u64 old_size, u64 size) -> bool {
+    allocator = allocator ? allocator : heap_allocator();
+    return data && allocator->resize_fn && allocator->resize_fn(allocator, data, old_size, size);
+}
+
+fn mem_realloc(Allocator* allocator, void* data, u64 old_size, u64 size, u64 align) -> void* {
+    allocator = allocator ? allocator : heap_allocator();
+    if (!data) {
+        return allocator->alloc_fn(allocator, size, align);
+    }
+    if (mem_resize(allocator, data, old_size, size)) {
+        return data;
+    }
+    if (allocator->realloc_fn) {
+        return allocator->realloc_fn(allocator, data, old_size, size, align);
+    }
+    void* moved = allocator->alloc_fn(allocator, size, align);
+    memcpy(moved, data, std::min(old_size, size));
+    allocator->free_fn(allocator, data, old_size);
+    return moved;
+}
+
+fn mem_free(Allocator* allocator, void* data, u64 size) -> void {
+    if (!data) {
+        return;
+    }
+    allocator = allocator ? allocator : heap_allocator();
+    allocator->free_fn(allocator, data, size);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+// @Note: Where a container takes its memory from (the heap, an arena, a pool...). A small table of functions picked
+// at runtime, so an Array<T> is the same type wherever its memory lives. Null means the heap everywhere.
+// The sizes come back on resize and free, so the allocators don't need headers in front of the blocks.
+struct Allocator {
+    // Uninitialized bytes, align is a power of two.
+    void* (*alloc_fn)(Allocator* allocator, u64 size, u64 align) = nullptr;
+    // Optional. Grows or shrinks the block without moving it, false if it can't.
+    bool (*resize_fn)(Allocator* allocator, void* data, u64 old_size, u64 size) = nullptr;
+    // Optional. Like realloc, the block may move with its bytes. Without it: alloc, memcpy and free.
+    void* (*realloc_fn)(Allocator* allocator, void* data, u64 old_size, u64 size, u64 align) = nullptr;
+    void (*free_fn)(Allocator* allocator, void* data, u64 size) = nullptr;
+};
+
+// @Note: malloc and friends, so up to their alignment (16 on x64).
+fn heap_allocator() -> Allocator*;
+
+fn mem_alloc(Allocator* allocator, u64 size, u64 align = 16) -> void*;
+fn mem_resize(Allocator* allocator, void* data, u64 old_size, u64 size) -> bool;
+// @Note: In place if it can, else it moves the bytes (only for trivially copyable data).
+fn mem_realloc(Allocator* allocator, void* data, u64 old_size, u64 size, u64 align = 16) -> void*;
+fn mem_free(Allocator* allocator, void* data, u64 size) -> void;
+
+// @Note: The same for the std containers (the Serializer's string...).
+template<typename T>
+struct Std_Allocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    Allocator* allocator = nullptr;
+
+    Std_Allocator() = default;
+    Std_Allocator(Allocator* allocator) : allocator(allocator) {}
+    template<typename U>
+    Std_Allocator(const Std_Allocator<U>& other) : allocator(other.allocator) {}
+
+    fn allocate(size_t n) -> T* { return (T*) mem_alloc(allocator, (u64) sizeof(T) * n, alignof(T)); }
+    fn deallocate(T* data, size_t n) -> void { mem_free(allocator, data, (u64) sizeof(T) * n); }
+
+    template<typename U>
+    fn operator==(const Std_Allocator<U>& other) const -> bool { return allocator == other.allocator; }
+    template<typename U>
+    fn operator!=(const Std_Allocator<U>& other) const -> bool { return allocator != other.allocator; }
+};
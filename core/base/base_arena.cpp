@@ -0,0 +1,172 @@
+#include "base_arena.h"
+
+static fn block_data(Arena_Block* block) -> u8* {
+    return (u8*) (block + 1);
+}
+
+static fn block_new(Arena* arena, u64 size) -> Arena_Block* {
+    Arena_Block* block = (Arena_Block*) mem_alloc(nullptr, sizeof(Arena_Block) + size);
+    *block = {};
+    block->size = size;
+    ++arena->block_allocs;
+    return block;
+}
+
+static fn block_free(Arena_Block* block) -> void {
+    mem_free(nullptr, block, sizeof(Arena_Block) + block->size);
+}
+
+static fn update_peak(Arena* arena) -> void {
+    arena->peak = std::max(arena->peak, arena->block->base + arena->block->used);
+}
+
+// @Note: Where a push of size (aligned) would start in the block, or ~0 if it doesn't fit.
+static fn block_fit(Arena_Block* block, u64 size, u64 align) -> u64 {
+    u64 start = (u64) (uintptr_t) block_data(block);
+    u64 offset = ((start + block->used + align - 1u) & ~(align - 1u)) - start;
+    return offset + size <= block->size ? offset : ~0ull;
+}
+
+static fn is_last_push(Arena* arena, void* data, u64 size) -> bool {
+    Arena_Block* block = arena->block;
+    return block && (u8*) data + size == block_data(block) + block->used && (u8*) data >= block_data(block);
+}
+
+static fn arena_alloc_fn(Allocator* allocator, u64 size, u64 align) -> void* {
+    return arena_push((Arena*) allocator, size, align);
+}
+
+static fn arena_resize_fn(Allocator* allocator, void* data, u64 old_size, u64 size) -> bool {
+    Arena* arena = (Arena*) allocator;
+    if (!is_last_push(arena, data, old_size)) {
+        return false;
+    }
+    u64 offset = (u64) ((u8*) data - block_data(arena->block));
+    if (offset + size > arena->block->size) {
+        return false;
+    }
+    arena->block->used = offset + size;
+    update_peak(arena);
+    return true;
+}
+
+static fn arena_free_fn(Allocator* allocator, void* data, u64 size) -> void {
+    Arena* arena = (Arena*) allocator;
+    if (is_last_push(arena, data, size)) {
+        arena->block->used -= size;
+    }
+}
+
+fn arena_init(Arena* arena, u64 block_size) -> void {
+    *arena = {};
+    arena->allocator.alloc_fn = arena_alloc_fn;
+    arena->allocator.resize_fn = arena_resize_fn;
+    arena->allocator.free_fn = arena_free_fn;
+    arena->block_size = block_size;
+}
+
+fn arena_done(Arena* arena) -> void {
+    while (arena->block) {
+        Arena_Block* prev = arena->block->prev;
+        block_free(arena->block);
+        arena->block = prev;
+    }
+    if (arena->spare) {
+        block_free(arena->spare);
+    }
+    *arena = {};
+}
+
+fn arena_push(Arena* arena, u64 size, u64 align) -> void* {
+    checkf(align > 0 && (align & (align - 1u)) == 0, "Error! The alignment must be a power of two!");
+    checkf(arena->block_size > 0, "Error! The arena is not initialized!");
+
+    u64 offset = arena->block ? block_fit(arena->block, size, align) : ~0ull;
+    if (offset == ~0ull) {
+        // @Note: align - 1 is the worst padding, so it always fits the new block.
+        u64 needed = size + align - 1u;
+        Arena_Block* block = arena->spare;
+        arena->spare = nullptr;
+        if (block && block->size < needed) {
+            block_free(block);
+            block = nullptr;
+        }
+        if (!block) {
+            block = block_new(arena, std::max(arena->block_size, needed));
+        }
+        block->prev = arena->block;
+        block->used = 0;
+        block->base = arena->block ? arena->block->base + arena->block->used : 0;
+        arena->block = block;
+        offset = block_fit(block, size, align);
+    }
+
+    arena->block->used = offset + size;
+    update_peak(arena);
+    return block_data(arena->block) + offset;
+}
+
+fn arena_pop(Arena* arena, u64 size) -> void {
+    checkf(arena->block && size <= arena->block->used, "Error! Popping more than the block has!");
+    arena->block->used -= size;
+}
+
+fn arena_marker(Arena* arena) -> Arena_Marker {
+    return { arena->block, arena->block ? arena->block->used : 0 };
+}
+
+fn arena_reset_to(Arena* arena, Arena_Marker marker) -> void {
+    while (arena->block != marker.block) {
+        checkf(arena->block, "Error! The marker is not from this arena!");
+        Arena_Block* block = arena->block;
+        arena->block = block->prev;
+        // Keeps the biggest one around.
+        if (arena->spare && arena->spare->size >= block->size) {
+            block_free(block);
+        } else {
+            if (arena->spare) {
+                block_free(arena->spare);
+            }
+            arena->spare = block;
+        }
+    }
+    if (arena->block) {
+        arena->block->used = marker.used;
+    }
+}
+
+fn arena_reset(Arena* arena) -> void {
+    if (arena->block && arena->block->prev) {
+        // Merged into one block that holds the peak, the next time it all fits there.
+        u64 size = std::max(arena->block_size, arena->peak);
+        arena_reset_to(arena, {});
+        if (arena->spare) {
+            block_free(arena->spare);
+            arena->spare = nullptr;
+        }
+        arena->block = block_new(arena, size);
+        return;
+    }
+    arena_reset_to(arena, { arena->block, 0 });
+}
+
+fn arena_used(const Arena& arena) -> u64 {
+    return arena.block ? arena.block->base + arena.block->used : 0;
+}
+
+fn arena_allocator(Arena* arena) -> Allocator* {
+    return &arena->allocator;
+}
+
+static Arena g_frame_arena;
+
+fn frame_arena() -> Arena* {
+    if (g_frame_arena.block_size == 0) {
+        arena_init(&g_frame_arena);
+    }
+    return &g_frame_arena;
+}
+
+fn frame_allocator() -> Allocator* {
+    return arena_allocator(frame_arena());
+}
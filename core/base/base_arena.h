@@ -0,0 +1,52 @@
+#pragma once
+
+// @Note: Linear allocator. A push bumps forward in the current block, pop and the markers take it back, nothing is
+// freed one by one: a whole frame (or a load, a tool pass...) goes at once. When a block runs out the next one
+// chains behind it, and a reset with more than one block in use merges them into a single block of the peak size,
+// so after a couple of frames a steady workload doesn't touch the heap anymore (see block_allocs).
+// Not thread safe, one arena per thread.
+struct Arena_Block {
+    Arena_Block* prev = nullptr;
+    u64 size = 0;  // Bytes after the header.
+    u64 used = 0;
+    u64 base = 0;  // Bytes in use in the blocks before this one.
+};
+
+struct Arena {
+    Allocator allocator; // First, the callbacks cast it back (see arena_allocator).
+    Arena_Block* block = nullptr; // The one being pushed to, the older ones behind prev.
+    Arena_Block* spare = nullptr; // Kept from the last reset_to, so going back and forth doesn't hit the heap.
+    u64 block_size = 0;
+    u64 peak = 0;         // Most bytes in use at once.
+    u64 block_allocs = 0; // Blocks taken from the heap so far.
+};
+
+struct Arena_Marker {
+    Arena_Block* block = nullptr;
+    u64 used = 0;
+};
+
+fn arena_init(Arena* arena, u64 block_size = 1ull << 20) -> void;
+fn arena_done(Arena* arena) -> void;
+// @Note: Uninitialized bytes, align is a power of two.
+fn arena_push(Arena* arena, u64 size, u64 align = 16) -> void*;
+// @Note: Gives back the last size bytes of the current block.
+fn arena_pop(Arena* arena, u64 size) -> void;
+fn arena_marker(Arena* arena) -> Arena_Marker;
+// @Note: Everything pushed after the marker goes back.
+fn arena_reset_to(Arena* arena, Arena_Marker marker) -> void;
+fn arena_reset(Arena* arena) -> void;
+fn arena_used(const Arena& arena) -> u64;
+// @Note: For the containers (Array::allocator...). Resize works on the last push, free gives back the last push,
+// the rest waits for the reset.
+fn arena_allocator(Arena* arena) -> Allocator*;
+
+template<typename T>
+fn arena_push_array(Arena* arena, u64 count) -> T* {
+    return (T*) arena_push(arena, (u64) sizeof(T) * count, alignof(T));
+}
+
+// @Note: Scratch memory for the current frame, app_running resets it at the start of every frame. Anything taken
+// from it must be dropped before that. Main thread only.
+fn frame_arena() -> Arena*;
+fn frame_allocator() -> Allocator*;
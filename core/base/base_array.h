@@ -1,11 +1,12 @@
 #pragma once
 
-// @Note: This is just a simple C-style resizeable array.
+// @Note: This is just a simple C-style resizeable array. The memory comes from its allocator (the heap if null, see
+// base_allocator.h), set it before the first reserve. The slots past count are uninitialized: trivially copyable
+// types grow with the allocator's realloc (in place when it can), the rest are move constructed into the new block.
+// An array with data but no cap is a view of memory it doesn't own (a mapped file...): reset leaves the memory
+// alone and the first grow copies the elements out.
 template<typename T>
 struct Array {
-    // @Robustness: (we could do this)
-    // static_assert(std::is_trivially_copyable_v<T>, "Array only supports trivially copyable types");
-    
     // @Note: C++ forces you to do freaking methods for some stuff.
     using Iterator = T *;
     using Const_Iterator = const T *;
@@ -23,8 +24,18 @@ struct Array {
     T* data = nullptr;
     u32 count = 0;
     u32 cap = 0;
+    Allocator* allocator = nullptr;
 };
 
+template<typename T>
+fn destroy_elements(T* data, u32 count) -> void {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (u32 i = 0; i < count; ++i) {
+            data[i].~T();
+        }
+    }
+}
+
 template<typename T>
 fn count(Array<T> array) -> u32 {
     return array.count;
@@ -33,10 +44,9 @@ fn count(Array<T> array) -> u32 {
 template<typename T>
 fn append(Array<T>* array, const T& elem = {}) -> T& {
     try_grow(array, 1);
-    auto& last = array->data[array->count];
-    last = elem;
+    T* last = new (array->data + array->count) T(elem);
     ++array->count;
-    return last;
+    return *last;
 }
 
 template<typename T>
@@ -44,15 +54,38 @@ fn reserve(Array<T>* array, u32 items) -> void {
     if (items <= array->cap) {
         return;
     }
-    T* prev_data = array->data;
-    u32 prev_cap = array->cap;
-    array->data = new T[items]();
-    array->cap = items;
-    if (prev_cap == 0) {
-        return;
+    u64 size = (u64) sizeof(T) * items;
+    u64 prev_size = (u64) sizeof(T) * array->cap;
+    bool owned = array->cap > 0;
+
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (owned) {
+            array->data = (T*) mem_realloc(array->allocator, array->data, prev_size, size, alignof(T));
+        } else {
+            T* data = (T*) mem_alloc(array->allocator, size, alignof(T));
+            if (array->count > 0) {
+                memcpy(data, array->data, (u64) sizeof(T) * array->count);
+            }
+            array->data = data;
+        }
+    } else {
+        if (!owned || !mem_resize(array->allocator, array->data, prev_size, size)) {
+            T* data = (T*) mem_alloc(array->allocator, size, alignof(T));
+            for (u32 i = 0; i < array->count; ++i) {
+                if (owned) {
+                    new (data + i) T(std::move(array->data[i]));
+                } else {
+                    new (data + i) T(array->data[i]);
+                }
+            }
+            if (owned) {
+                destroy_elements(array->data, array->count);
+                mem_free(array->allocator, array->data, prev_size);
+            }
+            array->data = data;
+        }
     }
-    memcpy(array->data, prev_data, (u64) sizeof(T) * array->count);
-    delete [] prev_data;
+    array->cap = items;
 }
 
 template<typename T>
@@ -70,7 +103,10 @@ fn try_grow(Array<T>* array, u32 items) -> bool {
 
 template<typename T>
 fn reset(Array<T>* array) -> void {
-    delete[] array->data;
+    if (array->cap > 0) {
+        destroy_elements(array->data, array->count);
+        mem_free(array->allocator, array->data, (u64) sizeof(T) * array->cap);
+    }
     array->data = nullptr;
     array->count = 0;
     array->cap = 0;
@@ -78,6 +114,7 @@ fn reset(Array<T>* array) -> void {
 
 template<typename T>
 fn reset_keeping_memory(Array<T>* array) -> void {
+    destroy_elements(array->data, array->count);
     array->count = 0;
 }
 
@@ -103,8 +140,9 @@ fn unordered_remove(Array<T>* array, u32 index) -> bool {
     }
     u32 last_index = array->count - 1;
     if (index != last_index) {
-        array->data[index] = array->data[last_index];
+        array->data[index] = std::move(array->data[last_index]);
     }
+    destroy_elements(array->data + last_index, 1);
     --array->count;
     return true;
 }
@@ -115,8 +153,9 @@ fn ordered_remove(Array<T>* array, u32 index) -> bool {
         return false;
     }
     for (u32 i = index; i < array->count - 1; ++i) {
-        array->data[i] = array->data[i + 1];
+        array->data[i] = std::move(array->data[i + 1]);
     }
+    destroy_elements(array->data + array->count - 1, 1);
     --array->count;
     return true;
 }
\ No newline at end of file
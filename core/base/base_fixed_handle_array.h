@@ -39,6 +39,9 @@ struct Fixed_Handle_Array {
     // Free list for O(1) add/remove
     u32* free_list = nullptr;
     u32 free_list_head = 0u;  // Index into free_list, 0 means empty (ZII)
+
+    // Where init takes the storage from (the heap if null, see base_allocator.h). Set it before the first append.
+    Allocator* allocator = nullptr;
     
     // Iterator for traversing only valid elements
     struct Iterator {
@@ -166,10 +169,17 @@ fn end(Fixed_Handle_Array<T, _cap> const& array) -> typename Fixed_Handle_Array<
 
 template<typename T, u32 _cap>
 fn init(Fixed_Handle_Array<T, _cap>* array) -> void {
+    using Elem_Info = typename Fixed_Handle_Array<T, _cap>::Elem_Info;
     constexpr u32 total_cap = Fixed_Handle_Array<T, _cap>::cap;
-    array->data = new T[total_cap]{};  // ZII: slot 0 is dummy element
-    array->info_data = new typename Fixed_Handle_Array<T, _cap>::Elem_Info[total_cap]{};
-    array->free_list = new u32[_cap]{};  // _cap usable slots (slot 0 excluded)
+    array->data = (T*) mem_alloc(array->allocator, sizeof(T) * total_cap, alignof(T));
+    for (u32 i = 0u; i < total_cap; ++i) {
+        new (&array->data[i]) T{};  // ZII: slot 0 is dummy element
+    }
+    array->info_data = (Elem_Info*) mem_alloc(array->allocator, sizeof(Elem_Info) * total_cap, alignof(Elem_Info));
+    for (u32 i = 0u; i < total_cap; ++i) {
+        new (&array->info_data[i]) Elem_Info{};
+    }
+    array->free_list = (u32*) mem_alloc(array->allocator, sizeof(u32) * _cap, alignof(u32));  // _cap usable slots (slot 0 excluded)
     array->count = 0u;
     array->free_list_head = 0u;
     
@@ -183,16 +193,19 @@ fn init(Fixed_Handle_Array<T, _cap>* array) -> void {
 
 template<typename T, u32 _cap>
 fn reset(Fixed_Handle_Array<T, _cap>* array) -> void {
+    using Elem_Info = typename Fixed_Handle_Array<T, _cap>::Elem_Info;
+    constexpr u32 total_cap = Fixed_Handle_Array<T, _cap>::cap;
     if (array->data) {
-        delete[] array->data;
+        destroy_elements(array->data, total_cap);
+        mem_free(array->allocator, array->data, sizeof(T) * total_cap);
         array->data = nullptr;
     }
     if (array->info_data) {
-        delete[] array->info_data;
+        mem_free(array->allocator, array->info_data, sizeof(Elem_Info) * total_cap);
         array->info_data = nullptr;
     }
     if (array->free_list) {
-        delete[] array->free_list;
+        mem_free(array->allocator, array->free_list, sizeof(u32) * _cap);
         array->free_list = nullptr;
     }
     array->count = 0u;
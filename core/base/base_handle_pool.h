@@ -0,0 +1,350 @@
+#pragma once
+
+// @Note: Fixed_Handle_Array that grows. The elements live in pages of page_size slots that never move: growing adds
+// a page (no copying), so pointers to the elements stay good. Same handles: index and generation, index 0 is never
+// valid (ZII). A page left with no elements goes back to the allocator once there's another empty one around, its
+// slots keep their generations so the old handles stay stale. Iterating skips the empty pages whole.
+template<typename T, u32 _page_size = 256u>
+struct Handle_Pool {
+    static constexpr u32 page_size = _page_size;
+
+    struct Slot_Info {
+        u32 generation = 0u;
+        u32 next_free = 0u; // Slot in the page + 1 of the next free one, 0 ends the list.
+        bool occupied = false;
+    };
+
+    struct Page {
+        T* data = nullptr;  // Null once given back.
+        u32 live = 0u;
+        u32 free_head = 0u; // Slot in the page + 1, 0 if it's full.
+        bool open = false;  // In open_pages.
+    };
+
+    Array<Page> pages;
+    Array<Slot_Info> info;   // page_size per page, kept when a page goes back.
+    Array<u32> open_pages;   // Pages with memory and free slots, the last one fills first.
+    u32 count = 0u;
+    u32 empty_pages = 0u;    // With memory but no elements.
+    u32 released_pages = 0u; // Without memory.
+
+    // Where the pages come from (the heap if null, see base_allocator.h). Set it before the first append.
+    Allocator* allocator = nullptr;
+
+    // Iterator for traversing only valid elements
+    struct Iterator {
+        Handle_Pool* pool;
+        u32 current_index;
+
+        Iterator(Handle_Pool* pool, u32 index)
+            : pool(pool), current_index(index) {
+            advance_to_next_valid();
+        }
+
+        fn advance_to_next_valid() -> void {
+            while (current_index < pool->info.count) {
+                u32 page = current_index / page_size;
+                if (pool->pages.data[page].live == 0u) {
+                    current_index = (page + 1u) * page_size;
+                } else if (!pool->info.data[current_index].occupied) {
+                    ++current_index;
+                } else {
+                    return;
+                }
+            }
+            current_index = pool->info.count;
+        }
+
+        fn operator*() -> T& {
+            return pool->pages.data[current_index / page_size].data[current_index % page_size];
+        }
+
+        fn operator->() -> T* {
+            return &**this;
+        }
+
+        fn operator++() -> Iterator& {
+            ++current_index;
+            advance_to_next_valid();
+            return *this;
+        }
+
+        fn operator==(const Iterator& other) const -> bool {
+            return current_index == other.current_index;
+        }
+
+        fn operator!=(const Iterator& other) const -> bool {
+            return current_index != other.current_index;
+        }
+
+        fn handle() const -> Array_Handle {
+            return {current_index, pool->info.data[current_index].generation};
+        }
+    };
+
+    // Const iterator
+    struct Const_Iterator {
+        const Handle_Pool* pool;
+        u32 current_index;
+
+        Const_Iterator(const Handle_Pool* pool, u32 index)
+            : pool(pool), current_index(index) {
+            advance_to_next_valid();
+        }
+
+        fn advance_to_next_valid() -> void {
+            while (current_index < pool->info.count) {
+                u32 page = current_index / page_size;
+                if (pool->pages.data[page].live == 0u) {
+                    current_index = (page + 1u) * page_size;
+                } else if (!pool->info.data[current_index].occupied) {
+                    ++current_index;
+                } else {
+                    return;
+                }
+            }
+            current_index = pool->info.count;
+        }
+
+        fn operator*() const -> const T& {
+            return pool->pages.data[current_index / page_size].data[current_index % page_size];
+        }
+
+        fn operator->() const -> const T* {
+            return &**this;
+        }
+
+        fn operator++() -> Const_Iterator& {
+            ++current_index;
+            advance_to_next_valid();
+            return *this;
+        }
+
+        fn operator==(const Const_Iterator& other) const -> bool {
+            return current_index == other.current_index;
+        }
+
+        fn operator!=(const Const_Iterator& other) const -> bool {
+            return current_index != other.current_index;
+        }
+
+        fn handle() const -> Array_Handle {
+            return {current_index, pool->info.data[current_index].generation};
+        }
+    };
+};
+
+template<typename T, u32 _page_size>
+fn begin(Handle_Pool<T, _page_size>& pool) -> typename Handle_Pool<T, _page_size>::Iterator {
+    return typename Handle_Pool<T, _page_size>::Iterator(&pool, 1u);
+}
+
+template<typename T, u32 _page_size>
+fn end(Handle_Pool<T, _page_size>& pool) -> typename Handle_Pool<T, _page_size>::Iterator {
+    return typename Handle_Pool<T, _page_size>::Iterator(&pool, pool.info.count);
+}
+
+template<typename T, u32 _page_size>
+fn begin(Handle_Pool<T, _page_size> const& pool) -> typename Handle_Pool<T, _page_size>::Const_Iterator {
+    return typename Handle_Pool<T, _page_size>::Const_Iterator(&pool, 1u);
+}
+
+template<typename T, u32 _page_size>
+fn end(Handle_Pool<T, _page_size> const& pool) -> typename Handle_Pool<T, _page_size>::Const_Iterator {
+    return typename Handle_Pool<T, _page_size>::Const_Iterator(&pool, pool.info.count);
+}
+
+// @Note: All the slots of the page go in its free list. Slot 0 of page 0 is the dummy, never handed out.
+template<typename T, u32 _page_size>
+fn _handle_pool_page_open(Handle_Pool<T, _page_size>* pool, u32 page_index) -> void {
+    auto& page = pool->pages.data[page_index];
+    u32 first = page_index == 0u ? 1u : 0u;
+    auto* info = pool->info.data + page_index * _page_size;
+    for (u32 i = first; i < _page_size; ++i) {
+        info[i].occupied = false;
+        info[i].next_free = i + 1u < _page_size ? i + 2u : 0u;
+    }
+    page.live = 0u;
+    page.free_head = first + 1u;
+    page.open = true;
+    append(&pool->open_pages, page_index);
+    ++pool->empty_pages;
+}
+
+template<typename T, u32 _page_size>
+fn _handle_pool_page_init(Handle_Pool<T, _page_size>* pool, u32 page_index) -> void {
+    auto& page = pool->pages.data[page_index];
+    page.data = (T*) mem_alloc(pool->allocator, sizeof(T) * _page_size, alignof(T));
+    for (u32 i = 0u; i < _page_size; ++i) {
+        new (&page.data[i]) T{};
+    }
+    _handle_pool_page_open(pool, page_index);
+}
+
+template<typename T, u32 _page_size>
+fn _handle_pool_page_done(Handle_Pool<T, _page_size>* pool, u32 page_index) -> void {
+    auto& page = pool->pages.data[page_index];
+    destroy_elements(page.data, _page_size);
+    mem_free(pool->allocator, page.data, sizeof(T) * _page_size);
+    page.data = nullptr;
+    page.free_head = 0u;
+    if (page.open) {
+        u32 i = 0u;
+        find(pool->open_pages, page_index, &i);
+        unordered_remove(&pool->open_pages, i);
+        page.open = false;
+    }
+}
+
+template<typename T, u32 _page_size>
+fn reset(Handle_Pool<T, _page_size>* pool) -> void {
+    for (u32 i = 0u; i < pool->pages.count; ++i) {
+        if (pool->pages.data[i].data) {
+            _handle_pool_page_done(pool, i);
+        }
+    }
+    reset(&pool->pages);
+    reset(&pool->info);
+    reset(&pool->open_pages);
+    pool->count = 0u;
+    pool->empty_pages = 0u;
+    pool->released_pages = 0u;
+}
+
+// @Note: Every handle goes stale, the pages with memory stay.
+template<typename T, u32 _page_size>
+fn reset_keeping_memory(Handle_Pool<T, _page_size>* pool) -> void {
+    reset_keeping_memory(&pool->open_pages);
+    pool->empty_pages = 0u;
+    for (u32 i = 0u; i < pool->pages.count; ++i) {
+        auto& page = pool->pages.data[i];
+        page.open = false;
+        if (!page.data) {
+            continue;
+        }
+        auto* info = pool->info.data + i * _page_size;
+        for (u32 slot = 0u; slot < _page_size; ++slot) {
+            if (info[slot].occupied) {
+                ++info[slot].generation;
+                page.data[slot] = T{};
+            }
+        }
+        _handle_pool_page_open(pool, i);
+    }
+    pool->count = 0u;
+}
+
+template<typename T, u32 _page_size>
+fn append(Handle_Pool<T, _page_size>* pool, const T& element = {}) -> Array_Handle {
+    if (pool->open_pages.count == 0u) {
+        // A page given back earlier, or a new one.
+        u32 page_index = pool->pages.count;
+        for (u32 i = 0u; pool->released_pages > 0u && i < pool->pages.count; ++i) {
+            if (!pool->pages.data[i].data) {
+                page_index = i;
+                --pool->released_pages;
+                break;
+            }
+        }
+        if (page_index == pool->pages.count) {
+            append(&pool->pages);
+            reserve(&pool->info, pool->info.count + _page_size);
+            for (u32 i = 0u; i < _page_size; ++i) {
+                append(&pool->info);
+            }
+        }
+        _handle_pool_page_init(pool, page_index);
+    }
+
+    u32 page_index = pool->open_pages.data[pool->open_pages.count - 1u];
+    auto& page = pool->pages.data[page_index];
+    u32 slot = page.free_head - 1u;
+    u32 index = page_index * _page_size + slot;
+    auto& info = pool->info.data[index];
+
+    page.free_head = info.next_free;
+    if (page.live == 0u) {
+        --pool->empty_pages;
+    }
+    ++page.live;
+    if (page.free_head == 0u) {
+        --pool->open_pages.count;
+        page.open = false;
+    }
+
+    page.data[slot] = element;
+    info.occupied = true;
+    ++pool->count;
+    return {index, info.generation};
+}
+
+template<typename T, u32 _page_size>
+fn remove(Handle_Pool<T, _page_size>* pool, Array_Handle handle) -> bool {
+    if (handle.index == 0u || handle.index >= pool->info.count) {
+        return false;
+    }
+    auto& info = pool->info.data[handle.index];
+    if (!info.occupied || info.generation != handle.generation) {
+        return false;
+    }
+
+    u32 page_index = handle.index / _page_size;
+    u32 slot = handle.index % _page_size;
+    auto& page = pool->pages.data[page_index];
+
+    info.occupied = false;
+    ++info.generation;
+    page.data[slot] = T{};
+    info.next_free = page.free_head;
+    page.free_head = slot + 1u;
+    --page.live;
+    --pool->count;
+    if (!page.open) {
+        append(&pool->open_pages, page_index);
+        page.open = true;
+    }
+
+    // @Note: One empty page stays, so spawning right after a despawn doesn't go to the allocator. Page 0 has the dummy.
+    if (page.live == 0u) {
+        if (pool->empty_pages > 0u && page_index != 0u) {
+            _handle_pool_page_done(pool, page_index);
+            ++pool->released_pages;
+        } else {
+            ++pool->empty_pages;
+        }
+    }
+    return true;
+}
+
+// @Note: The dummy, slot 0 of page 0. Null before the first append, like Fixed_Handle_Array.
+template<typename T, u32 _page_size>
+fn get_default(const Handle_Pool<T, _page_size>& pool) -> T* {
+    return pool.pages.count > 0u ? &pool.pages.data[0].data[0] : nullptr;
+}
+
+template<typename T, u32 _page_size>
+fn get(const Handle_Pool<T, _page_size>& pool, Array_Handle handle) -> T* {
+    if (!is_valid(pool, handle)) {
+        return get_default(pool);
+    }
+    return &pool.pages.data[handle.index / _page_size].data[handle.index % _page_size];
+}
+
+template<typename T, u32 _page_size>
+fn is_valid(const Handle_Pool<T, _page_size>& pool, Array_Handle handle) -> bool {
+    if (handle.index == 0u || handle.index >= pool.info.count) {
+        return false;
+    }
+    const auto& info = pool.info.data[handle.index];
+    return info.occupied && info.generation == handle.generation;
+}
+
+template<typename T, u32 _page_size>
+fn count(const Handle_Pool<T, _page_size>& pool) -> u32 {
+    return pool.count;
+}
+
+template<typename T, u32 _page_size>
+fn is_empty(const Handle_Pool<T, _page_size>& pool) -> bool {
+    return pool.count == 0u;
+}
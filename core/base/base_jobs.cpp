@@ -0,0 +1,174 @@
+#include "base_jobs.h"
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+struct Job {
+    Job_Fn run = nullptr;
+    void* data = nullptr;
+    Job_Counter* counter = nullptr;
+};
+
+struct Job_Pool {
+    static constexpr s32 max_workers = 64;
+    static constexpr u32 max_jobs = 1024; // Ring of queued jobs. When it's full the job runs inline.
+
+    std::thread workers[max_workers];
+    s32 worker_count = 0;
+
+    Job queue[max_jobs];
+    u32 head = 0; // Next to pop.
+    u32 tail = 0; // Next to push.
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool quit = false;
+} g_jobs;
+
+static fn run_job(const Job& job) -> void {
+    job.run(job.data);
+    job.counter->pending.fetch_sub(1, std::memory_order_release);
+}
+
+// @Note: Only the jobs of counter. The one found swaps places with the head, so it pops like the rest.
+static fn try_pop(Job* job, Job_Counter* counter) -> bool {
+    std::lock_guard<std::mutex> lock(g_jobs.mutex);
+    for (u32 i = g_jobs.head; i != g_jobs.tail; ++i) {
+        Job& it = g_jobs.queue[i % g_jobs.max_jobs];
+        if (it.counter == counter) {
+            Job& head = g_jobs.queue[g_jobs.head % g_jobs.max_jobs];
+            *job = it;
+            it = head;
+            ++g_jobs.head;
+            return true;
+        }
+    }
+    return false;
+}
+
+static fn worker_main() -> void {
+    for (;;) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(g_jobs.mutex);
+            g_jobs.wake.wait(lock, [] { return g_jobs.quit || g_jobs.head != g_jobs.tail; });
+            if (g_jobs.head == g_jobs.tail) {
+                return; // Quit with nothing left.
+            }
+            job = g_jobs.queue[g_jobs.head % g_jobs.max_jobs];
+            ++g_jobs.head;
+        }
+        run_job(job);
+    }
+}
+
+fn jobs_init(s32 worker_count) -> void {
+    if (g_jobs.worker_count > 0) {
+        jobs_done();
+    }
+    if (worker_count < 0) {
+        worker_count = (s32) std::thread::hardware_concurrency() - 1;
+    }
+    worker_count = std::clamp(worker_count, 0, g_jobs.max_workers);
+
+    g_jobs.quit = false;
+    g_jobs.worker_count = worker_count;
+    for (s32 i = 0; i < worker_count; ++i) {
+        g_jobs.workers[i] = std::thread(worker_main);
+    }
+}
+
+fn jobs_done() -> void {
+    {
+        std::lock_guard<std::mutex> lock(g_jobs.mutex);
+        g_jobs.quit = true;
+    }
+    g_jobs.wake.notify_all();
+    for (s32 i = 0; i < g_jobs.worker_count; ++i) {
+        g_jobs.workers[i].join();
+    }
+    g_jobs.worker_count = 0;
+    g_jobs.head = 0;
+    g_jobs.tail = 0;
+}
+
+fn jobs_worker_count() -> s32 {
+    return g_jobs.worker_count;
+}
+
+fn jobs_run(Job_Fn job, void* data, Job_Counter* counter) -> void {
+    checkf(job && counter, "Error! A job needs a function and a counter!");
+    counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+    if (g_jobs.worker_count == 0) {
+        run_job({ job, data, counter });
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_jobs.mutex);
+        if (g_jobs.tail - g_jobs.head < g_jobs.max_jobs) {
+            g_jobs.queue[g_jobs.tail % g_jobs.max_jobs] = { job, data, counter };
+            ++g_jobs.tail;
+            g_jobs.wake.notify_one();
+            return;
+        }
+    }
+
+    run_job({ job, data, counter });
+}
+
+fn jobs_wait(Job_Counter* counter) -> void {
+    while (counter->pending.load(std::memory_order_acquire) > 0) {
+        Job job;
+        if (try_pop(&job, counter)) {
+            run_job(job);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+fn parallel_for(s32 count, s32 grain, Range_Fn job, void* user) -> void {
+    if (count <= 0) {
+        return;
+    }
+
+    // @Note: A few ranges per thread, so a slow one doesn't leave the rest waiting.
+    constexpr s32 max_ranges = 256;
+    s32 threads = g_jobs.worker_count + 1;
+    s32 ranges = std::min({ (count + grain - 1) / std::max(grain, 1), threads * 4, max_ranges });
+
+    if (ranges <= 1 || g_jobs.worker_count == 0) {
+        job(user, 0, count);
+        return;
+    }
+
+    struct Range {
+        Range_Fn job;
+        void* user;
+        s32 first;
+        s32 count;
+    } data[max_ranges];
+
+    Job_Fn run_range = [](void* data) {
+        Range* range = (Range*) data;
+        range->job(range->user, range->first, range->count);
+    };
+
+    Job_Counter counter;
+    s32 first = 0;
+    for (s32 i = 0; i < ranges; ++i) {
+        s32 range_count = count / ranges + (i < count % ranges ? 1 : 0);
+        data[i] = { job, user, first, range_count };
+        first += range_count;
+        // @Note: The last one runs here, the rest go to the workers.
+        if (i < ranges - 1) {
+            jobs_run(run_range, &data[i], &counter);
+        }
+    }
+
+    run_range(&data[ranges - 1]);
+    jobs_wait(&counter);
+}
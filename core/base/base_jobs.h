@@ -0,0 +1,32 @@
+#pragma once
+#include <atomic>
+
+// @Note: A small pool of worker threads. The thread that waits helps running the queued jobs of the counter it waits
+// on (only those, so a frame's parallel_for never ends up decoding an image someone else queued). With 0 workers (or
+// before jobs_init) everything simply runs on the calling thread.
+
+using Job_Fn = void (*)(void* data);
+
+struct Job_Counter {
+    std::atomic<s32> pending = 0;
+};
+
+fn jobs_init(s32 worker_count = -1) -> void; // -1: one worker per core, minus the calling thread.
+fn jobs_done() -> void;
+fn jobs_worker_count() -> s32;
+fn jobs_run(Job_Fn job, void* data, Job_Counter* counter) -> void;
+fn jobs_wait(Job_Counter* counter) -> void;
+
+// @Note: Splits [0, count) in ranges of at least grain items and runs job(user, first, count) on each one.
+// Returns when every range is done.
+using Range_Fn = void (*)(void* user, s32 first, s32 count);
+fn parallel_for(s32 count, s32 grain, Range_Fn job, void* user) -> void;
+
+// @Note: Ex: parallel_for(count, 1024, [&](s32 first, s32 count) { ... });
+template<typename F>
+fn parallel_for(s32 count, s32 grain, const F& f) -> void {
+    Range_Fn job = [](void* user, s32 first, s32 count) {
+        (*(const F*) user)(first, count);
+    };
+    parallel_for(count, grain, job, (void*) &f);
+}
@@ -7,6 +7,7 @@
 #include <math.h>
 #include <stdint.h>
 #include <float.h>
+#include <string.h>
 
 inline fn clamp(f32 value, f32 min_value, f32 max_value) -> f32 {
     return (value < min_value) ? min_value : (value > max_value) ? max_value : value;
@@ -441,3 +442,97 @@ struct AABB {
 
     static fn overlap(const AABB& a, const AABB& b) -> bool;
 };
+
+// =========================================
+// @Region: Packed formats (see the packed Data_Types).
+// =========================================
+
+struct Half2 { u16 x = 0, y = 0; };
+struct Half4 { u16 x = 0, y = 0, z = 0, w = 0; };
+
+// @Note: f32 -> 16 bit float, rounding to nearest even. Too big goes to infinity, too small to (signed) zero.
+inline fn pack_half(f32 value) -> u16 {
+    u32 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    u32 sign = (bits >> 16) & 0x8000u;
+    u32 abs  = bits & 0x7FFFFFFFu;
+
+    if (abs >= 0x7F800000u) { // Inf, NaN.
+        return (u16) (sign | 0x7C00u | (abs > 0x7F800000u ? 0x200u : 0u));
+    }
+    if (abs >= 0x477FF000u) { // Rounds above 65504.
+        return (u16) (sign | 0x7C00u);
+    }
+    if (abs < 0x38800000u) { // Half denormals.
+        if (abs < 0x33000000u) {
+            return (u16) sign;
+        }
+        u32 exponent = abs >> 23;
+        u32 mantissa = (abs & 0x7FFFFFu) | 0x800000u;
+        u32 shift = 126u - exponent;
+        u32 half = mantissa >> shift;
+        u32 rest = mantissa & ((1u << shift) - 1u);
+        u32 mid  = 1u << (shift - 1u);
+        if (rest > mid || (rest == mid && (half & 1u))) {
+            ++half;
+        }
+        return (u16) (sign | half);
+    }
+
+    u32 half = (abs - 0x38000000u) >> 13; // Rebias the exponent 127 -> 15.
+    u32 rest = abs & 0x1FFFu;
+    if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+        ++half; // May carry into the exponent, that's fine.
+    }
+    return (u16) (sign | half);
+}
+
+inline fn unpack_half(u16 value) -> f32 {
+    u32 sign = (u32) (value & 0x8000u) << 16;
+    u32 exponent = (value >> 10) & 0x1Fu;
+    u32 mantissa = value & 0x3FFu;
+    u32 bits;
+    if (exponent == 0x1Fu) {
+        bits = sign | 0x7F800000u | (mantissa << 13);
+    } else if (exponent != 0u) {
+        bits = sign | ((exponent + 112u) << 23) | (mantissa << 13);
+    } else if (mantissa != 0u) {
+        f32 denormal = (f32) mantissa * (1.0f / 16777216.0f); // * 2^-24
+        return sign ? -denormal : denormal;
+    } else {
+        bits = sign;
+    }
+    f32 result;
+    memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+inline fn pack_half2(f32 x, f32 y) -> Half2 {
+    return { pack_half(x), pack_half(y) };
+}
+
+inline fn pack_half4(const Vec4& v) -> Half4 {
+    return { pack_half(v.x), pack_half(v.y), pack_half(v.z), pack_half(v.w) };
+}
+
+// @Note: RGBA in memory order (r in the lowest byte), what GL_UNSIGNED_BYTE x4 expects.
+inline fn pack_unorm8x4(const Vec4& color) -> u32 {
+    u32 r = (u32) (clamp(color.x, 0.0f, 1.0f) * 255.0f + 0.5f);
+    u32 g = (u32) (clamp(color.y, 0.0f, 1.0f) * 255.0f + 0.5f);
+    u32 b = (u32) (clamp(color.z, 0.0f, 1.0f) * 255.0f + 0.5f);
+    u32 a = (u32) (clamp(color.w, 0.0f, 1.0f) * 255.0f + 0.5f);
+    return r | (g << 8) | (b << 16) | (a << 24);
+}
+
+inline fn pack_snorm16(f32 value) -> s16 {
+    return (s16) lroundf(clamp(value, -1.0f, 1.0f) * 32767.0f);
+}
+
+// @Note: x in the lowest bits, what GL_INT_2_10_10_10_REV expects. w is -1, 0 or 1 (ex: the tangent handedness).
+inline fn pack_snorm1010102(const Vec3& v, f32 w = 0.0f) -> u32 {
+    u32 x = (u32) lroundf(clamp(v.x, -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+    u32 y = (u32) lroundf(clamp(v.y, -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+    u32 z = (u32) lroundf(clamp(v.z, -1.0f, 1.0f) * 511.0f) & 0x3FFu;
+    u32 a = (u32) lroundf(clamp(w, -1.0f, 1.0f)) & 0x3u;
+    return x | (y << 10) | (z << 20) | (a << 30);
+}
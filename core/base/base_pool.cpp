@@ -0,0 +1,141 @@
+#include "base_pool.h"
+
+static constexpr u64 pool_align = 16;
+
+// @Note: 16, 32 ... 128, then 4 steps per doubling: 160, 192, 224, 256, 320...
+static fn class_size(u32 index) -> u32 {
+    if (index < 8u) {
+        return (index + 1u) * 16u;
+    }
+    u32 doubling = 128u << ((index - 8u) / 4u);
+    return doubling + (doubling / 4u) * ((index - 8u) % 4u + 1u);
+}
+
+static fn class_index(u64 size) -> u32 {
+    if (size <= 128u) {
+        return size == 0 ? 0u : (u32) ((size - 1u) / 16u);
+    }
+    u32 index = 8u;
+    while (class_size(index) < size) {
+        ++index;
+    }
+    return index;
+}
+
+static fn pool_alloc_fn(Allocator* allocator, u64 size, u64 align) -> void* {
+    return pool_alloc((Pool*) allocator, size, align);
+}
+
+static fn pool_free_fn(Allocator* allocator, void* data, u64 size) -> void {
+    pool_free((Pool*) allocator, data, size);
+}
+
+fn pool_init(Pool* pool, u64 page_size, bool poison) -> void {
+    checkf(page_size >= pool_max_size, "Error! The pages must fit the biggest class!");
+    *pool = {};
+    pool->allocator.alloc_fn = pool_alloc_fn;
+    pool->allocator.free_fn = pool_free_fn;
+    pool->page_size = page_size;
+    pool->poison = poison;
+    for (u32 i = 0; i < pool_class_count; ++i) {
+        Pool_Class& it = pool->classes[i];
+        it.size = class_size(i);
+        it.slots_per_page = (u32) (page_size / it.size);
+    }
+    checkf(class_size(pool_class_count - 1u) == pool_max_size, "Error! The classes don't end at pool_max_size!");
+}
+
+fn pool_done(Pool* pool) -> void {
+    checkf(pool->heap_live == 0, "Error! %llu pool allocations were not freed!", pool->heap_live);
+    for (Pool_Class& it : pool->classes) {
+        checkf(it.stats.live == 0, "Error! %llu slots of %u bytes were not freed!", it.stats.live, it.size);
+        for (u8* page : it.pages) {
+            mem_free(nullptr, page, pool->page_size);
+        }
+        reset(&it.pages);
+    }
+    *pool = {};
+}
+
+// @Note: The new page's slots go on the free list, the first one on top.
+static fn class_grow(Pool* pool, Pool_Class* it) -> void {
+    u8* page = (u8*) mem_alloc(nullptr, pool->page_size, pool_align);
+    append(&it->pages, page);
+    for (u32 i = it->slots_per_page; i-- > 0;) {
+        void* slot = page + (u64) i * it->size;
+        *(void**) slot = it->free_list;
+        it->free_list = slot;
+    }
+    ++it->stats.pages;
+    it->stats.reserved += pool->page_size;
+}
+
+fn pool_alloc(Pool* pool, u64 size, u64 align) -> void* {
+    checkf(align <= pool_align, "Error! The pool only aligns up to %llu bytes!", pool_align);
+    if (size > pool_max_size) {
+        ++pool->heap_live;
+        return mem_alloc(nullptr, size, align);
+    }
+
+    Pool_Class* it = &pool->classes[class_index(size)];
+    if (!it->free_list) {
+        class_grow(pool, it);
+    }
+    void* slot = it->free_list;
+    it->free_list = *(void**) slot;
+
+    ++it->stats.live;
+    it->stats.high_water = std::max(it->stats.high_water, it->stats.live);
+    it->requested += size;
+    if (pool->poison) {
+        memset(slot, 0xCD, it->size);
+    }
+    return slot;
+}
+
+fn pool_free(Pool* pool, void* data, u64 size) -> void {
+    if (!data) {
+        return;
+    }
+    if (size > pool_max_size) {
+        --pool->heap_live;
+        mem_free(nullptr, data, size);
+        return;
+    }
+
+    Pool_Class* it = &pool->classes[class_index(size)];
+    checkf(it->stats.live > 0, "Error! Freeing more slots of %u bytes than there are!", it->size);
+    if (pool->poison) {
+        memset(data, 0xDD, it->size);
+    }
+    *(void**) data = it->free_list;
+    it->free_list = data;
+    --it->stats.live;
+    it->requested -= size;
+}
+
+fn pool_class_stats(const Pool& pool, u32 class_index) -> Pool_Stats {
+    const Pool_Class& it = pool.classes[class_index];
+    Pool_Stats stats = it.stats;
+    u64 page_tail = pool.page_size - (u64) it.slots_per_page * it.size;
+    stats.wasted = stats.live * it.size - it.requested + stats.pages * page_tail;
+    return stats;
+}
+
+// @Note: The high water mark is the sum of the classes', they may not have peaked at the same time.
+fn pool_stats(const Pool& pool) -> Pool_Stats {
+    Pool_Stats stats;
+    for (u32 i = 0; i < pool_class_count; ++i) {
+        Pool_Stats it = pool_class_stats(pool, i);
+        stats.live += it.live;
+        stats.high_water += it.high_water;
+        stats.pages += it.pages;
+        stats.reserved += it.reserved;
+        stats.wasted += it.wasted;
+    }
+    return stats;
+}
+
+fn pool_allocator(Pool* pool) -> Allocator* {
+    return &pool->allocator;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// @Note: Allocator for small fixed size records (entities, sounds, gl wrappers...). The sizes are rounded up to a
+// class, every class carves its own pages into equal slots and keeps the free ones in a list threaded through them,
+// so alloc and free are a pop and a push and records of a kind end up next to each other. Sizes past the last class
+// go to the heap. With poison on (GAME_DEBUG by default) new slots are filled with 0xCD and freed ones with 0xDD,
+// so reading stale memory shows. Not thread safe.
+static constexpr u32 pool_class_count = 36;   // 16 bytes to 16 KB, 4 classes per doubling past 128.
+static constexpr u64 pool_max_size = 16u << 10;
+
+struct Pool_Stats {
+    u64 live = 0;       // Slots in use.
+    u64 high_water = 0; // Most slots in use at once.
+    u64 pages = 0;
+    u64 reserved = 0;   // Bytes of the pages.
+    u64 wasted = 0;     // Bytes of the live slots past what was asked for, plus the page tails no slot fits in.
+};
+
+struct Pool_Class {
+    u32 size = 0;
+    u32 slots_per_page = 0;
+    void* free_list = nullptr;
+    Array<u8*> pages;
+    u64 requested = 0; // Bytes asked for by the live slots.
+    Pool_Stats stats;
+};
+
+struct Pool {
+    Allocator allocator; // First, the callbacks cast it back (see pool_allocator).
+    Pool_Class classes[pool_class_count];
+    u64 page_size = 0;
+    bool poison = false;
+    u64 heap_live = 0; // Allocations past pool_max_size.
+};
+
+#ifdef GAME_DEBUG
+    static constexpr bool pool_default_poison = true;
+#else
+    static constexpr bool pool_default_poison = false;
+#endif
+
+fn pool_init(Pool* pool, u64 page_size = 64u << 10, bool poison = pool_default_poison) -> void;
+fn pool_done(Pool* pool) -> void;
+// @Note: 16 byte aligned at most.
+fn pool_alloc(Pool* pool, u64 size, u64 align = 16) -> void*;
+// @Note: size as given to pool_alloc.
+fn pool_free(Pool* pool, void* data, u64 size) -> void;
+fn pool_stats(const Pool& pool) -> Pool_Stats;
+fn pool_class_stats(const Pool& pool, u32 class_index) -> Pool_Stats;
+fn pool_allocator(Pool* pool) -> Allocator*;
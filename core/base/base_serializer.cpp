@@ -1,5 +1,10 @@
 #include "base_serializer.h"
 
+fn serializer_init(Serializer* s, Allocator* allocator) -> void {
+    s->out = Serializer_String(Std_Allocator<char>(allocator));
+    s->indent_level = 0;
+}
+
 fn serialize_indent(Serializer* s) -> void {
     s32 indent = s->indent_level * s->indent_size;
     s->out.append(indent, ' ');
@@ -1,11 +1,16 @@
 #pragma once
 
+using Serializer_String = std::basic_string<char, std::char_traits<char>, Std_Allocator<char>>;
+
 struct Serializer {
     static constexpr s32 indent_size = 4;
-    std::string out;
+    Serializer_String out; // On the heap unless serializer_init says otherwise.
     s32 indent_level = 0;
 };
 
+// @Note: Ex: serializer_init(&s, frame_allocator()) for text that only lives this frame.
+fn serializer_init(Serializer* s, Allocator* allocator) -> void;
+
 fn serialize_indent(Serializer* s) -> void;
 fn serialize_block_init(Serializer* s) -> void;
 fn serialize_block_done(Serializer* s) -> void;
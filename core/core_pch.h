@@ -4,9 +4,14 @@
 #include <string>
 #include <cmath> // For some f* reason tinyobj makes the compilation fail if we don't include this globally.
 #include <type_traits>
+#include <new>
 
 #include "base.h"
 #include "base_math.h"
+#include "base_allocator.h"
 #include "base_array.h"
+#include "base_arena.h"
+#include "base_pool.h"
 #include "base_serializer.h"
-#include "base_fixed_handle_array.h"
\ No newline at end of file
+#include "base_fixed_handle_array.h"
+#include "base_handle_pool.h"
@@ -1,32 +1,156 @@
 #include "draw.h"
+#include "base_jobs.h"
 #include "graphics.h"
 #include "io_image.h"
+#include "os_core.h"
+
+// @Note: A submitted sprite, kept until the queue is sorted at the end of the frame.
+struct Draw_Command {
+    const Texture* tex;
+    s32 array_layer; // Only Texture_Kind::Array.
+    Vec4 uv_rect; // UV offset (xy), UV size (zw).
+    Vec4 tint;
+    Mat4 transform;
+};
+
+// @Note: Sort key layout, from the most significant bit:
+// | layer (8) | depth (24) | shader (8) | texture (16) | material (8) |
+// Layer and depth keep the layering right, the rest groups the state changes inside the same depth.
+// The fields sit on byte boundaries so a field that doesn't change costs no radix pass.
+struct Sort_Key {
+    static constexpr u32 layer_shift    = 56;
+    static constexpr u32 depth_shift    = 32;
+    static constexpr u32 shader_shift   = 24;
+    static constexpr u32 texture_shift  = 8;
+    static constexpr u32 material_shift = 0;
+};
+
+// @Note: A draw_sprites call. It takes a single queue entry, so its sprites keep their order and stay together.
+struct Draw_Bulk {
+    const Texture* tex;
+    s32 array_layer;
+    Sprite_Soa sprites;
+};
+
+struct Sort_Entry {
+    static constexpr u32 bulk_bit = 1u << 31;
+    u64 key;
+    u32 index; // Into the commands, or into the bulks with the bulk_bit.
+};
 
 struct {
+    Array<Draw_Command> commands;
+    Array<Draw_Bulk> bulks;
+    Array<Sort_Entry> entries;
+    u8 layer = 0;
+} queue;
+
+struct Sprite_Batch {
+    static constexpr s32 verts_per_sprite = 4;
+    static constexpr s32 elems_per_sprite = 6;
+    static constexpr s32 max = 10000; // Max sprites per drawcall.
+
+    Draw_Path path = Draw_Path::Batched;
+    s32 count = 0; // Current sprites.
+
+    // @Note: The sprites are written straight into the stream. Mapped when the first sprite arrives.
+    // Layout of a batch: | global data (uniform aligned) | vertices or instances |
+    Stream_Buffer stream;
+    Stream_Alloc alloc;
+    s32 global_size = 0;
+
+    // Draw_Path::Batched
     Vertex_Buffer vbo;
     Shader shader;
-} quad;
+
+    // Draw_Path::Instanced
+    Vertex_Buffer quad_vbo;
+    Shader quad_shader;
+} batch;
+
+// @Note: The 2D textures take the units [0, max) and the arrays [max, 2 * max), as u_samplers and u_array_samplers.
+// A sprite sends its unit packed with the array layer: unit | layer << 8.
+struct Tex_Slots {
+    static constexpr s32 max = 16;
+    Texture data[max];
+    s32 count = 0;
+};
+
+Tex_Slots tex_slots;
+Tex_Slots array_slots;
 
 struct {
-    Global_Buffer gbo;
     Texture white;
 
     struct {
         Mat4 projection = Mat.Identity4;
-        Mat4 transform = Mat.Identity4;
-        Vec2 uv_size = F32.One;
-        Vec2 uv_offset = F32.Zero;
-        Vec4 tint = Color.White;
-        s32  tex_unit = 0;
     } global_data;
+
+    Draw_Stats stats;
+    Draw_Stats last_stats;
 } scene;
 
+static fn set_samplers(Shader shader) -> void {
+    // @Note: The sampler indices never change, so we send them just once.
+    s32 samplers[Tex_Slots::max];
+    s32 array_samplers[Tex_Slots::max];
+    for (s32 i = 0; i < Tex_Slots::max; ++i) {
+        samplers[i] = i;
+        array_samplers[i] = Tex_Slots::max + i;
+    }
+    shader_set_param(shader, shader_param(shader, hash_str("u_samplers")), samplers, Tex_Slots::max);
+    shader_set_param(shader, shader_param(shader, hash_str("u_array_samplers")), array_samplers, Tex_Slots::max);
+}
+
 fn draw_init() -> void {
 
-    // Quad init.
+    const char* shader_filename = "shader_sprite.glsl";
+
+    // Batched path init.
+    {
+        constexpr Data_Type attrs[] = {
+            Data_Type::Float3,   // Position.
+            Data_Type::Half2,    // UVs.
+            Data_Type::UNorm8x4, // Tint Color.
+            Data_Type::Int,      // Texture Unit.
+        };
+
+        constexpr s32 max_elems = batch.max * batch.elems_per_sprite;
+
+        // Sprite 0:  0, 1, 2, 2, 3, 0
+        // Sprite 1:  4, 5, 6, 6, 7, 4
+        // etc...
+        u32* elems = new u32[max_elems];
+        for (s32 i = 0; i < batch.max; ++i) {
+            u32 elem_offset = i * batch.elems_per_sprite;
+            u32 vert_offset = i * batch.verts_per_sprite;
+            // Triangle 1
+            elems[elem_offset + 0] = vert_offset + 0;
+            elems[elem_offset + 1] = vert_offset + 1;
+            elems[elem_offset + 2] = vert_offset + 2;
+            // Triangle 2
+            elems[elem_offset + 3] = vert_offset + 2;
+            elems[elem_offset + 4] = vert_offset + 3;
+            elems[elem_offset + 5] = vert_offset + 0;
+        }
+
+        // @Note: No vertex view, the vertices come from the stream.
+        Vertex_Buffer_Def vbo_def = {
+            { },
+            { elems, max_elems },
+            { attrs, /* attribute count * */ 4 },
+        };
+        vertex_buffer_init(&batch.vbo, vbo_def);
+        delete[] elems;
+
+        shader_init(&batch.shader, { shader_filename });
+        set_samplers(batch.shader);
+    }
+
+    // Instanced path init.
     {
         constexpr f32 verts[] = {
-            -0.5f, -0.5f,  0.0f, 0.0f, 
+            -0.5f, -0.5f,  0.0f, 0.0f,
             +0.5f, -0.5f,  1.0f, 0.0f,
             +0.5f, +0.5f,  1.0f, 1.0f,
             -0.5f, +0.5f,  0.0f, 1.0f,
@@ -36,23 +160,38 @@ fn draw_init() -> void {
             2u, 3u, 0u, // Triangle 2
         };
         constexpr Data_Type attrs[] = {
-            Data_Type::Float2,
-            Data_Type::Float2,
+            Data_Type::Float2, // Position.
+            Data_Type::Float2, // UVs.
+        };
+        constexpr Data_Type inst_attrs[] = {
+            Data_Type::Float4,   // Basis.
+            Data_Type::Float3,   // Origin.
+            Data_Type::Half4,    // UV Rect.
+            Data_Type::UNorm8x4, // Tint Color.
+            Data_Type::Int,      // Texture Unit.
         };
 
         Vertex_Buffer_Def vbo_def = {
             { verts, sizeof(verts), /* vertex count */ 4 },
             { elems, /* element count */ 6 },
             { attrs, /* attribute count * */ 2 },
+            { }, // @Note: The instances come from the stream.
+            { inst_attrs, /* attribute count * */ 5 },
         };
-        vertex_buffer_init(&quad.vbo, vbo_def);
-        
-        const char* shader_filename = "shader_sprite.glsl";
-        shader_init(&quad.shader, {shader_filename});
+        vertex_buffer_init(&batch.quad_vbo, vbo_def);
 
-        global_buffer_init(&scene.gbo, { sizeof(scene.global_data) });
+        shader_init(&batch.quad_shader, { shader_filename, "#define INSTANCED \n" });
+        set_samplers(batch.quad_shader);
     }
 
+    // @Note: A region holds a full batch of the biggest path plus a few global blocks.
+    constexpr s32 region_size = 4 * 1024 * 1024;
+    static_assert(sizeof(Sprite_Vertex) * batch.verts_per_sprite * batch.max + 64 * 1024 < region_size);
+    stream_buffer_init(&batch.stream, { region_size, /* regions */ 3 });
+
+    s32 align = batch.stream.uniform_align;
+    batch.global_size = ((s32) sizeof(scene.global_data) + align - 1) / align * align;
+
     Texture_Def def;
     def.image = io_image_white();
     texture_init(&scene.white, def);
@@ -62,63 +201,439 @@ fn draw_init() -> void {
     f32 nearpl = -1.0f;
     f32 farpl = +1.0f;
     scene.global_data.projection = Mat4::transpose(Mat4::orthographic(aspect, zoom, nearpl, farpl));
+
+    draw_frame_init();
 }
 
-fn draw_sprite(const Texture* tex, s32 icell, Vec4 tint, const Mat4& transform) -> void {
+// @Note: Maps the float so the unsigned order matches the float order (negatives flipped), keeps the top 24 bits.
+static fn depth_bits(f32 depth) -> u64 {
+    u32 bits;
+    memcpy(&bits, &depth, sizeof(bits));
+    bits = (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+    return bits >> 8;
+}
+
+static fn make_sort_key(u8 layer, f32 depth, u32 shader, u32 texture, u32 material) -> u64 {
+    return ((u64) layer                 << Sort_Key::layer_shift)
+         | (depth_bits(depth)           << Sort_Key::depth_shift)
+         | ((u64) (shader   & 0xFFu)    << Sort_Key::shader_shift)
+         | ((u64) (texture  & 0xFFFFu)  << Sort_Key::texture_shift)
+         | ((u64) (material & 0xFFu)    << Sort_Key::material_shift);
+}
+
+// @Note: LSD radix sort over 8 bit digits, stable so equal keys keep the submission order.
+// Most key bits don't change in a frame (layer, shader, material...), so we first find the digits that differ
+// between keys and only count and scatter those.
+static fn radix_sort(Sort_Entry* entries, Sort_Entry* temp, u32 count) -> Sort_Entry* {
+    constexpr u32 max_digits = sizeof(u64);
+
+    u64 first = entries[0].key;
+    u64 diff = 0;
+    for (u32 i = 1; i < count; ++i) {
+        diff |= entries[i].key ^ first;
+    }
+
+    u32 digits[max_digits];
+    u32 digit_count = 0;
+    for (u32 d = 0; d < max_digits; ++d) {
+        if ((diff >> (d * 8)) & 0xFFu) {
+            digits[digit_count++] = d * 8;
+        }
+    }
+
+    static u32 histograms[max_digits][256];
+    memset(histograms, 0, sizeof(u32) * 256 * digit_count);
+
+    for (u32 i = 0; i < count; ++i) {
+        u64 key = entries[i].key;
+        for (u32 d = 0; d < digit_count; ++d) {
+            ++histograms[d][(key >> digits[d]) & 0xFFu];
+        }
+    }
+
+    Sort_Entry* src = entries;
+    Sort_Entry* dst = temp;
+
+    for (u32 d = 0; d < digit_count; ++d) {
+        u32* histogram = histograms[d];
+        u32 offset = 0;
+        for (u32 i = 0; i < 256; ++i) {
+            u32 bucket = histogram[i];
+            histogram[i] = offset;
+            offset += bucket;
+        }
+
+        u32 shift = digits[d];
+        for (u32 i = 0; i < count; ++i) {
+            dst[histogram[(src[i].key >> shift) & 0xFFu]++] = src[i];
+        }
+
+        std::swap(src, dst);
+    }
+
+    return src;
+}
+
+static fn reset_batch() -> void {
+    batch.count = 0;
+    batch.alloc = {};
+    // @Note: The white texture is always at unit 0.
+    tex_slots.data[0] = scene.white;
+    tex_slots.count = 1;
+    array_slots.count = 0;
+}
+
+static fn flush() -> void {
+
+    ++scene.stats.flushes;
+
+    if (batch.count == 0) {
+        reset_batch();
+        return;
+    }
 
     ser_blend_enabled();
-    
+
+    for (s32 i = 0; i < tex_slots.count; ++i) {
+        texture_use(tex_slots.data[i], i);
+    }
+    for (s32 i = 0; i < array_slots.count; ++i) {
+        texture_use(array_slots.data[i], Tex_Slots::max + i);
+    }
+
+    s32 size = batch.path == Draw_Path::Batched
+             ? sizeof(Sprite_Vertex) * batch.verts_per_sprite * batch.count
+             : sizeof(Sprite_Instance) * batch.count;
+
+    // @Note: Everything this draw reads lives in one committed range. If we allocated the global data apart, the
+    // stream could move to another region in between and fence this one before the draw is submitted.
+    stream_buffer_commit(&batch.stream, batch.alloc, batch.global_size + size);
+    scene.stats.bytes += size;
+
+    Stream_Alloc global = { batch.alloc.data, batch.alloc.offset, (s32) sizeof(scene.global_data) };
+    memcpy(global.data, &scene.global_data, sizeof(scene.global_data));
+    global_buffer_use(batch.stream, global);
+
+    s32 sprites_offset = batch.alloc.offset + batch.global_size;
+
+    switch (batch.path) {
+        case Draw_Path::Batched: {
+            shader_use(batch.shader);
+            vertex_buffer_set_source(batch.vbo, batch.stream, sprites_offset);
+            vertex_buffer_draw(batch.vbo, batch.elems_per_sprite * batch.count);
+        } break;
+        case Draw_Path::Instanced: {
+            shader_use(batch.quad_shader);
+            vertex_buffer_set_instance_source(batch.quad_vbo, batch.stream, sprites_offset);
+            vertex_buffer_draw_instanced(batch.quad_vbo, batch.count);
+        } break;
+    }
+
+    ++scene.stats.draw_calls;
+
+    reset_batch();
+}
+
+static fn give_tex_unit(const Texture* tex) -> s32 {
+
+    // Invalid tex, use white.
+    if (!tex || tex->tex == 0u) {
+        return 0;
+    }
+
+    bool is_array = tex->kind == Texture_Kind::Array;
+    Tex_Slots& slots = is_array ? array_slots : tex_slots;
+    s32 first_unit = is_array ? Tex_Slots::max : 0;
+
+    // Search the tex.
+    for (s32 slot = 0; slot < slots.count; ++slot) {
+        if (slots.data[slot].tex == tex->tex) {
+            return first_unit + slot; // Found.
+        }
+    }
+
+    // Check if we filled all the tex slots in this batch.
+    if (slots.count >= slots.max) {
+        flush();
+    }
+
+    // Not found. Add to last unit.
+    s32 slot = slots.count;
+    slots.data[slot] = *tex;
+    ++slots.count;
+
+    return first_unit + slot;
+}
+
+fn draw_frame_init() -> void {
+    scene.stats = {};
+    reset_keeping_memory(&queue.commands);
+    reset_keeping_memory(&queue.bulks);
+    reset_keeping_memory(&queue.entries);
+    queue.layer = 0;
+    stream_buffer_reset_stats(&batch.stream);
+    graphics_reset_stats();
+    reset_batch();
+}
+
+fn draw_set_path(Draw_Path path) -> void {
+    if (batch.path == path) {
+        return;
+    }
+    // @Note: The queue is submitted at draw_frame_done, so the whole frame goes through the last path set.
+    batch.path = path;
+}
+
+fn draw_set_layer(u8 layer) -> void {
+    queue.layer = layer;
+}
+
+fn draw_layer() -> u8 {
+    return queue.layer;
+}
+
+fn draw_path() -> Draw_Path {
+    return batch.path;
+}
+
+// @Note: Where the sprites of the current batch go. Maps the stream when the first sprite arrives.
+static fn map_batch() -> u8* {
+    if (batch.count == 0) {
+        s32 max_size = batch.path == Draw_Path::Batched
+                     ? sizeof(Sprite_Vertex) * batch.verts_per_sprite * batch.max
+                     : sizeof(Sprite_Instance) * batch.max;
+        batch.alloc = stream_buffer_map(&batch.stream, batch.global_size + max_size, batch.stream.uniform_align);
+    }
+    return (u8*) batch.alloc.data + batch.global_size;
+}
+
+static fn emit_sprite(const Draw_Command& cmd) -> void {
+
+    if (batch.count == batch.max) {
+        flush();
+    }
+
+    // @Note: Must go before writing the sprite, it may flush the batch.
+    s32 tex_unit = give_tex_unit(cmd.tex) | (cmd.array_layer << 8);
+
+    u8* sprites = map_batch();
+    const Mat4& transform = cmd.transform;
+    Vec2 uv_offset = { cmd.uv_rect.x, cmd.uv_rect.y };
+    Vec2 uv_size   = { cmd.uv_rect.z, cmd.uv_rect.w };
+
+    switch (batch.path) {
+        case Draw_Path::Batched: {
+            constexpr Vec4 sprite_verts[] = {
+                {-0.5f, -0.5f, 0.0f, 1.0f},
+                {+0.5f, -0.5f, 0.0f, 1.0f},
+                {+0.5f, +0.5f, 0.0f, 1.0f},
+                {-0.5f, +0.5f, 0.0f, 1.0f},
+            };
+
+            constexpr Vec2 sprite_uvs[] = {
+                {0.0f, 0.0f},
+                {1.0f, 0.0f},
+                {1.0f, 1.0f},
+                {0.0f, 1.0f},
+            };
+
+            Sprite_Vertex* verts = (Sprite_Vertex*) sprites + batch.count * batch.verts_per_sprite;
+            u32 tint = pack_unorm8x4(cmd.tint);
+
+            for (s32 i = 0; i < batch.verts_per_sprite; ++i) {
+                Sprite_Vertex& vertex = verts[i];
+                Vec4 pos = transform * sprite_verts[i];
+                Vec2 uv  = sprite_uvs[i] * uv_size + uv_offset;
+                vertex.pos      = { pos.x, pos.y, pos.z };
+                vertex.uv       = pack_half2(uv.x, uv.y);
+                vertex.tint     = tint;
+                vertex.tex_unit = tex_unit;
+            }
+        } break;
+        case Draw_Path::Instanced: {
+            Sprite_Instance& inst = ((Sprite_Instance*) sprites)[batch.count];
+            inst.basis    = { transform._11, transform._21, transform._12, transform._22 };
+            inst.origin   = { transform._14, transform._24, transform._34 };
+            inst.uv_rect  = pack_half4(cmd.uv_rect);
+            inst.tint     = pack_unorm8x4(cmd.tint);
+            inst.tex_unit = tex_unit;
+        } break;
+    }
+
+    ++batch.count;
+}
+
+// @Note: The bulk is split in as many batches as it needs. The kernel fills each one across the worker threads,
+// the ranges write to disjoint parts of the mapped stream.
+static fn emit_bulk(const Draw_Bulk& bulk) -> void {
+    constexpr s32 grain = 2048; // Sprites per job, less is not worth the wake up.
+
+    const Sprite_Soa& in = bulk.sprites;
+    s32 done = 0;
+    while (done < in.count) {
+        if (batch.count == batch.max) {
+            flush();
+        }
+
+        s32 tex_unit = give_tex_unit(bulk.tex) | (bulk.array_layer << 8);
+        u8* sprites = map_batch();
+        s32 first = done;
+        s32 count = std::min(in.count - done, batch.max - batch.count);
+
+        switch (batch.path) {
+            case Draw_Path::Batched: {
+                Sprite_Vertex* verts = (Sprite_Vertex*) sprites + batch.count * batch.verts_per_sprite;
+                parallel_for(count, grain, [&](s32 range_first, s32 range_count) {
+                    kernel_sprite_vertices(in, first + range_first, range_count, tex_unit, verts + range_first * batch.verts_per_sprite);
+                });
+            } break;
+            case Draw_Path::Instanced: {
+                Sprite_Instance* insts = (Sprite_Instance*) sprites + batch.count;
+                parallel_for(count, grain, [&](s32 range_first, s32 range_count) {
+                    kernel_sprite_instances(in, first + range_first, range_count, tex_unit, insts + range_first);
+                });
+            } break;
+        }
+
+        batch.count += count;
+        done += count;
+    }
+}
+
+// @Note: Subtex goes top to bottom in texture pixels, the uvs bottom to top.
+static fn subtex_uv_rect(const Texture& tex, Subtex rect) -> Vec4 {
+    return {
+        (f32) rect.x / (f32) tex.width,
+        1.0f - ((f32)rect.y + rect.height) / tex.height,
+        (f32) rect.width  / (f32) tex.width,
+        (f32) rect.height / (f32) tex.height
+    };
+}
+
+static fn queue_sprite(const Texture* tex, s32 array_layer, Vec4 uv_rect, Vec4 tint, const Mat4& transform) -> void {
+
+    // @Note: Invalid textures draw with the white one, which takes the texture id 0.
+    if (tex && tex->tex == 0u) {
+        tex = nullptr;
+    }
+
+    // @Note: Every sprite shares the shader and material for now, the key keeps room for them.
+    u32 texture = tex ? tex->tex : 0u;
+    u64 key = make_sort_key(queue.layer, transform._34, /* shader */ 0u, texture, /* material */ 0u);
+
+    append(&queue.entries, { key, queue.commands.count });
+    append(&queue.commands, { tex, array_layer, uv_rect, tint, transform });
+    ++scene.stats.sprites;
+}
+
+fn draw_sprite(const Texture* tex, s32 icell, Vec4 tint, const Mat4& transform) -> void {
+
+    Vec4 uv_rect = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    // @Note: Array textures select the layer, the uvs cover it whole.
+    if (tex && tex->kind == Texture_Kind::Array) {
+        if (!ensuref(icell >= 0 && icell < tex->layers, "Error! Layer %i does not exist!", icell)) {
+            return;
+        }
+        queue_sprite(tex, icell, uv_rect, tint, transform);
+        return;
+    }
+
     if (tex && tex->cells.count) {
-        if (!ensuref(icell < tex->cells.count, "Error! Cell %i does not exist!", 20)) {
+        if (!ensuref(icell < tex->cells.count, "Error! Cell %i does not exist!", icell)) {
             return;
         }
-    
-        auto& cell = tex->cells.data[icell];
-
-        scene.global_data.uv_size = { 
-            (f32) cell.width  / (f32) tex->width, 
-            (f32) cell.height / (f32) tex->height 
-        }; 
-        
-        scene.global_data.uv_offset = { 
-            (f32) cell.x / (f32) tex->width, 
-            1.0f - ((f32)cell.y + cell.height) / tex->height
-        };
+        uv_rect = subtex_uv_rect(*tex, tex->cells.data[icell]);
     }
 
-    scene.global_data.transform = Mat4::transpose(transform);
-    scene.global_data.tint = tint;
+    queue_sprite(tex, 0, uv_rect, tint, transform);
+}
+
+fn draw_sprite(const Texture* tex, Subtex rect, Vec4 tint, const Mat4& transform) -> void {
+    checkf(tex && tex->kind != Texture_Kind::Array, "Error! A Subtex needs its 2D Texture!");
+    queue_sprite(tex, 0, subtex_uv_rect(*tex, rect), tint, transform);
+}
+
+fn draw_sprite(Vec4 tint, const Mat4& transform) -> void {
+    queue_sprite(nullptr, 0, { 0.0f, 0.0f, 1.0f, 1.0f }, tint, transform);
+}
 
-    texture_use(scene.white, 0u);
+fn draw_sprites(const Texture* tex, const Sprite_Soa& sprites, s32 array_layer) -> void {
+    if (sprites.count <= 0) {
+        return;
+    }
+    checkf(sprites.pos_x && sprites.pos_y && sprites.rot && sprites.scl_x && sprites.scl_y, "Error! Missing sprite arrays!");
 
-    if (tex) {
-        scene.global_data.tex_unit = 1;
-        texture_use(*tex, /* unit */ 1u);
+    if (tex && tex->tex == 0u) {
+        tex = nullptr;
+    }
+    if (tex && tex->kind == Texture_Kind::Array) {
+        if (!ensuref(array_layer >= 0 && array_layer < tex->layers, "Error! Layer %i does not exist!", array_layer)) {
+            return;
+        }
     } else {
-        scene.global_data.tex_unit = 0;
+        array_layer = 0;
     }
 
-    shader_use(quad.shader);
+    u32 texture = tex ? tex->tex : 0u;
+    f32 depth = sprites.pos_z ? sprites.pos_z[0] : 0.0f;
+    u64 key = make_sort_key(queue.layer, depth, /* shader */ 0u, texture, /* material */ 0u);
 
-    s32 samplers[32];
-    for (s32 i = 0; i < 32; ++i) {
-        samplers[i] = i;
+    append(&queue.entries, { key, queue.bulks.count | Sort_Entry::bulk_bit });
+    append(&queue.bulks, { tex, array_layer, sprites });
+    scene.stats.sprites += sprites.count;
+}
+
+static fn submit_queue() -> void {
+    u32 count = queue.entries.count;
+    if (count == 0) {
+        return;
     }
 
-    shader_set_param(quad.shader, "u_samplers", samplers, 32);
+    // @Note: The sort's second buffer is frame scratch, given back once the queue is out.
+    Arena_Marker marker = arena_marker(frame_arena());
+    f64 sort_start = os_get_time();
+    Sort_Entry* temp = arena_push_array<Sort_Entry>(frame_arena(), count);
+    Sort_Entry* sorted = radix_sort(queue.entries.data, temp, count);
+    scene.stats.sort_ms = (f32) ((os_get_time() - sort_start) * 1000.0);
 
-    global_buffer_update(scene.gbo, &scene.global_data);
-    global_buffer_use(scene.gbo);
+    for (u32 i = 0; i < count; ++i) {
+        u32 index = sorted[i].index;
+        if (index & Sort_Entry::bulk_bit) {
+            emit_bulk(queue.bulks.data[index & ~Sort_Entry::bulk_bit]);
+        } else {
+            emit_sprite(queue.commands.data[index]);
+        }
+    }
+    arena_reset_to(frame_arena(), marker);
+}
 
-    vertex_buffer_draw(quad.vbo);
+fn draw_frame_done() -> void {
+    submit_queue();
+    flush();
+    scene.stats.stalls = batch.stream.stats.stalls;
+    Graphics_Stats gl_stats = graphics_stats();
+    scene.stats.gl_issued = gl_stats.issued;
+    scene.stats.gl_elided = gl_stats.elided;
+    scene.last_stats = scene.stats;
 }
 
-fn draw_sprite(Vec4 tint, const Mat4& transform) -> void {
-    draw_sprite(nullptr, 0, tint, transform);
+fn draw_stats() -> Draw_Stats {
+    return scene.last_stats;
 }
 
 fn draw_done() -> void {
-    global_buffer_done(&scene.gbo);
-    vertex_buffer_done(&quad.vbo);
-    shader_done(&quad.shader);
-}
\ No newline at end of file
+    stream_buffer_done(&batch.stream);
+    texture_done(&scene.white);
+    vertex_buffer_done(&batch.vbo);
+    vertex_buffer_done(&batch.quad_vbo);
+    shader_done(&batch.shader);
+    shader_done(&batch.quad_shader);
+    batch.count = 0;
+    batch.alloc = {};
+    tex_slots.count = 0;
+    array_slots.count = 0;
+    reset(&queue.commands);
+    reset(&queue.bulks);
+    reset(&queue.entries);
+}
@@ -1,7 +1,41 @@
 #pragma once
 #include "graphics.h"
+#include "draw_kernel.h"
+
+// @Note: How the sprites reach the gpu. Both paths share the batching rules, so they can be benchmarked against each other.
+enum class Draw_Path : u8 {
+    Batched,   // 4 transformed vertices per sprite.
+    Instanced, // 1 instance per sprite (2D affine + uv rect + tint + texture) over a static unit quad.
+};
+
+// @Note: Sprite counters of the last finished frame (see draw_frame_done).
+struct Draw_Stats {
+    s32 sprites = 0;
+    s32 flushes = 0;    // Times the batch was closed (full batch, no free texture slots or frame end).
+    s32 draw_calls = 0; // Flushes that actually had something to draw.
+    s32 bytes = 0;      // Vertex/instance bytes sent to the gpu.
+    s32 stalls = 0;     // Times we waited for the gpu to release stream memory.
+    s32 gl_issued = 0;  // State changing gl calls (see Graphics_Stats).
+    s32 gl_elided = 0;  // Redundant state changes skipped by the state cache.
+    f32 sort_ms = 0.0f; // Time spent sorting the render queue.
+};
 
 fn draw_init() -> void;
+fn draw_frame_init() -> void;
+fn draw_set_path(Draw_Path path) -> void;
+fn draw_path() -> Draw_Path;
+// @Note: The sprites are queued and sorted at draw_frame_done. Higher layers draw on top, inside a layer the lower
+// depth (z translation) goes first. Sprites at the same layer and depth are grouped by texture, so their order is not kept.
+fn draw_set_layer(u8 layer) -> void;
+fn draw_layer() -> u8;
+// @Note: icell is the tileset cell, or the layer of a Texture_Kind::Array.
 fn draw_sprite(const Texture* tex, s32 icell, Vec4 tint, const Mat4& transform) -> void;
+fn draw_sprite(const Texture* tex, Subtex rect, Vec4 tint, const Mat4& transform) -> void;
 fn draw_sprite(Vec4 tint, const Mat4& transform) -> void;
-fn draw_done() -> void;
\ No newline at end of file
+// @Note: Many 2D sprites with the same texture, built by the sprite kernel (see Sprite_Soa) instead of one Mat4 each.
+// The arrays are read at draw_frame_done, so they must live until then. The bulk sorts as a whole by the depth of
+// its first sprite, and inside it the sprites keep their order.
+fn draw_sprites(const Texture* tex, const Sprite_Soa& sprites, s32 array_layer = 0) -> void;
+fn draw_frame_done() -> void;
+fn draw_stats() -> Draw_Stats;
+fn draw_done() -> void;
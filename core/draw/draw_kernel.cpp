@@ -0,0 +1,170 @@
+#include "draw_kernel.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#   define KERNEL_X86 1
+#   include <emmintrin.h>
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#else
+#   define KERNEL_X86 0
+#endif
+
+#if KERNEL_X86
+
+// @Note: SSE2 is the x64 baseline, so this one needs no check. No _mm_round_ps (SSE4.1): rounds through the int conversion,
+// which uses the default rounding mode (to nearest). The rotations are small enough to fit an s32 after scaling.
+struct Wide_Sse {
+    static constexpr s32 lanes = 4;
+    using F = __m128;
+    static fn load(const f32* p) -> F { return _mm_loadu_ps(p); }
+    static fn store(f32* p, F v) -> void { _mm_store_ps(p, v); }
+    static fn set1(f32 v) -> F { return _mm_set1_ps(v); }
+    static fn add(F a, F b) -> F { return _mm_add_ps(a, b); }
+    static fn sub(F a, F b) -> F { return _mm_sub_ps(a, b); }
+    static fn mul(F a, F b) -> F { return _mm_mul_ps(a, b); }
+    static fn min(F a, F b) -> F { return _mm_min_ps(a, b); }
+    static fn max(F a, F b) -> F { return _mm_max_ps(a, b); }
+    static fn round(F a) -> F { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }
+
+    static fn half4(const Vec4& v) -> Half4 { return pack_half4(v); } // No F16C here.
+
+    static fn unorm8x4(const Vec4& v) -> u32 {
+        __m128 c = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&v.x), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i i = _mm_cvtps_epi32(_mm_mul_ps(c, _mm_set1_ps(255.0f)));
+        i = _mm_packs_epi32(i, i);
+        return (u32) _mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+    }
+};
+
+#include "draw_kernel_wide.h"
+
+// draw_kernel_avx2.cpp
+fn kernel_sprite_vertices_avx2(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Vertex* out) -> s32;
+fn kernel_sprite_instances_avx2(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Instance* out) -> s32;
+
+static fn cpuid(u32 leaf, u32 subleaf, u32 regs[4]) -> void {
+#ifdef _MSC_VER
+    __cpuidex((int*) regs, (int) leaf, (int) subleaf);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static fn xgetbv0() -> u64 {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    u32 lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((u64) hi << 32) | lo;
+#endif
+}
+
+#endif
+
+fn kernel_isa_supported() -> Kernel_Isa {
+#if KERNEL_X86
+    u32 regs[4];
+    cpuid(0, 0, regs);
+    if (regs[0] < 7) {
+        return Kernel_Isa::SSE;
+    }
+
+    // @Note: AVX2 needs the cpu flags (leaf 1: osxsave, avx, fma, f16c; leaf 7: avx2) and the OS saving the ymm registers.
+    cpuid(1, 0, regs);
+    bool osxsave = regs[2] & (1u << 27);
+    bool avx     = regs[2] & (1u << 28);
+    bool fma     = regs[2] & (1u << 12);
+    bool f16c    = regs[2] & (1u << 29);
+    if (!osxsave || !avx || !fma || !f16c || (xgetbv0() & 0x6) != 0x6) {
+        return Kernel_Isa::SSE;
+    }
+
+    cpuid(7, 0, regs);
+    bool avx2 = regs[1] & (1u << 5);
+    return avx2 ? Kernel_Isa::AVX2 : Kernel_Isa::SSE;
+#else
+    return Kernel_Isa::Scalar;
+#endif
+}
+
+static Kernel_Isa g_isa = kernel_isa_supported();
+
+fn kernel_isa() -> Kernel_Isa {
+    return g_isa;
+}
+
+fn kernel_set_isa(Kernel_Isa isa) -> void {
+    g_isa = std::min(isa, kernel_isa_supported());
+}
+
+static fn scalar_sprite_vertices(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Vertex* out) -> void {
+    constexpr Vec2 corners[] = { {-0.5f, -0.5f}, {+0.5f, -0.5f}, {+0.5f, +0.5f}, {-0.5f, +0.5f} };
+    constexpr s32 corner_u[] = { 0, 1, 1, 0 };
+    constexpr s32 corner_v[] = { 0, 0, 1, 1 };
+
+    for (s32 n = 0; n < count; ++n) {
+        s32 i = first + n;
+        f32 sin = sinf(in.rot[i]);
+        f32 cos = cosf(in.rot[i]);
+        f32 a = cos * in.scl_x[i], b = sin * in.scl_x[i];
+        f32 c = -sin * in.scl_y[i], d = cos * in.scl_y[i];
+        f32 z = in.pos_z ? in.pos_z[i] : 0.0f;
+        Vec4 rect = in.uv_rect ? in.uv_rect[i] : Vec4{ 0.0f, 0.0f, 1.0f, 1.0f };
+        u32 tint = in.tint ? pack_unorm8x4(in.tint[i]) : 0xFFFFFFFFu;
+        u16 u[2] = { pack_half(rect.x), pack_half(rect.x + rect.z) };
+        u16 v[2] = { pack_half(rect.y), pack_half(rect.y + rect.w) };
+
+        Sprite_Vertex* verts = out + n * 4;
+        for (s32 corner = 0; corner < 4; ++corner) {
+            Vec2 p = corners[corner];
+            Sprite_Vertex& vertex = verts[corner];
+            vertex.pos      = { in.pos_x[i] + a * p.x + c * p.y, in.pos_y[i] + b * p.x + d * p.y, z };
+            vertex.uv       = { u[corner_u[corner]], v[corner_v[corner]] };
+            vertex.tint     = tint;
+            vertex.tex_unit = tex_unit;
+        }
+    }
+}
+
+static fn scalar_sprite_instances(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Instance* out) -> void {
+    for (s32 n = 0; n < count; ++n) {
+        s32 i = first + n;
+        f32 sin = sinf(in.rot[i]);
+        f32 cos = cosf(in.rot[i]);
+
+        Sprite_Instance& inst = out[n];
+        inst.basis    = { cos * in.scl_x[i], sin * in.scl_x[i], -sin * in.scl_y[i], cos * in.scl_y[i] };
+        inst.origin   = { in.pos_x[i], in.pos_y[i], in.pos_z ? in.pos_z[i] : 0.0f };
+        inst.uv_rect  = pack_half4(in.uv_rect ? in.uv_rect[i] : Vec4{ 0.0f, 0.0f, 1.0f, 1.0f });
+        inst.tint     = in.tint ? pack_unorm8x4(in.tint[i]) : 0xFFFFFFFFu;
+        inst.tex_unit = tex_unit;
+    }
+}
+
+fn kernel_sprite_vertices(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Vertex* out) -> void {
+    s32 done = 0;
+#if KERNEL_X86
+    switch (g_isa) {
+        case Kernel_Isa::AVX2:   done = kernel_sprite_vertices_avx2(in, first, count, tex_unit, out); break;
+        case Kernel_Isa::SSE:    done = wide_sprite_vertices<Wide_Sse>(in, first, count, tex_unit, out); break;
+        case Kernel_Isa::Scalar: break;
+    }
+#endif
+    scalar_sprite_vertices(in, first + done, count - done, tex_unit, out + done * 4);
+}
+
+fn kernel_sprite_instances(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Instance* out) -> void {
+    s32 done = 0;
+#if KERNEL_X86
+    switch (g_isa) {
+        case Kernel_Isa::AVX2:   done = kernel_sprite_instances_avx2(in, first, count, tex_unit, out); break;
+        case Kernel_Isa::SSE:    done = wide_sprite_instances<Wide_Sse>(in, first, count, tex_unit, out); break;
+        case Kernel_Isa::Scalar: break;
+    }
+#endif
+    scalar_sprite_instances(in, first + done, count - done, tex_unit, out + done);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+// @Note: Packed layouts, 24 and 44 bytes (they were 44 and 52 with floats). The positions keep full floats,
+// the half uvs stay under half a texel of error up to 2048 pixel textures.
+struct Sprite_Vertex {
+    Vec3  pos;
+    Half2 uv;
+    u32   tint;     // UNorm8x4.
+    s32   tex_unit; // unit | array layer << 8.
+};
+
+// @Note: Only the 2D affine part of the transform travels (rotations around z).
+struct Sprite_Instance {
+    Vec4  basis;    // x axis (_11, _21), y axis (_12, _22).
+    Vec3  origin;   // Translation (_14, _24, _34).
+    Half4 uv_rect;  // UV offset (xy), UV size (zw).
+    u32   tint;     // UNorm8x4.
+    s32   tex_unit; // unit | array layer << 8.
+};
+
+// @Note: Sprites as SoA arrays, the input of the kernels. The rotation is around z in radians, so the transform
+// is a 2D affine built once per sprite: the same as Mat4::transform({ x, y, z }, { 0, 0, rot }, { sx, sy, 1 }).
+// uv_rect (offset xy, size zw) and tint are optional, the whole texture and white if null.
+struct Sprite_Soa {
+    const f32* pos_x = nullptr;
+    const f32* pos_y = nullptr;
+    const f32* pos_z = nullptr;
+    const f32* rot = nullptr;
+    const f32* scl_x = nullptr;
+    const f32* scl_y = nullptr;
+    const Vec4* uv_rect = nullptr;
+    const Vec4* tint = nullptr;
+    s32 count = 0;
+};
+
+enum class Kernel_Isa : u8 {
+    Scalar,
+    SSE,  // 4 sprites per step.
+    AVX2, // 8 sprites per step.
+};
+
+// @Note: The best one the cpu supports is picked at startup, set_isa is there to benchmark them (it won't go above that one).
+fn kernel_isa() -> Kernel_Isa;
+fn kernel_set_isa(Kernel_Isa isa) -> void;
+fn kernel_isa_supported() -> Kernel_Isa;
+
+// @Note: Writes the sprites [first, first + count), 4 vertices (or 1 instance) each, from out[0] on.
+// Different ranges can go to different threads.
+fn kernel_sprite_vertices(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Vertex* out) -> void;
+fn kernel_sprite_instances(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Instance* out) -> void;
@@ -0,0 +1,45 @@
+// @Note: Only reached after checking the cpu (see kernel_isa_supported). MSVC takes the AVX2 intrinsics as they are,
+// GCC and Clang need the target for this translation unit.
+#if defined(__GNUC__) || defined(__clang__)
+#   pragma GCC target("avx2,fma,f16c")
+#endif
+
+#include "draw_kernel.h"
+#include <immintrin.h>
+
+struct Wide_Avx2 {
+    static constexpr s32 lanes = 8;
+    using F = __m256;
+    static fn load(const f32* p) -> F { return _mm256_loadu_ps(p); }
+    static fn store(f32* p, F v) -> void { _mm256_store_ps(p, v); }
+    static fn set1(f32 v) -> F { return _mm256_set1_ps(v); }
+    static fn add(F a, F b) -> F { return _mm256_add_ps(a, b); }
+    static fn sub(F a, F b) -> F { return _mm256_sub_ps(a, b); }
+    static fn mul(F a, F b) -> F { return _mm256_mul_ps(a, b); }
+    static fn min(F a, F b) -> F { return _mm256_min_ps(a, b); }
+    static fn max(F a, F b) -> F { return _mm256_max_ps(a, b); }
+    static fn round(F a) -> F { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+    static fn half4(const Vec4& v) -> Half4 {
+        Half4 result;
+        _mm_storel_epi64((__m128i*) &result, _mm_cvtps_ph(_mm_loadu_ps(&v.x), _MM_FROUND_TO_NEAREST_INT));
+        return result;
+    }
+
+    static fn unorm8x4(const Vec4& v) -> u32 {
+        __m128 c = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(&v.x), _mm_setzero_ps()), _mm_set1_ps(1.0f));
+        __m128i i = _mm_cvtps_epi32(_mm_mul_ps(c, _mm_set1_ps(255.0f)));
+        i = _mm_packs_epi32(i, i);
+        return (u32) _mm_cvtsi128_si32(_mm_packus_epi16(i, i));
+    }
+};
+
+#include "draw_kernel_wide.h"
+
+fn kernel_sprite_vertices_avx2(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Vertex* out) -> s32 {
+    return wide_sprite_vertices<Wide_Avx2>(in, first, count, tex_unit, out);
+}
+
+fn kernel_sprite_instances_avx2(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Instance* out) -> s32 {
+    return wide_sprite_instances<Wide_Avx2>(in, first, count, tex_unit, out);
+}
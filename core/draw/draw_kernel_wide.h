@@ -0,0 +1,133 @@
+#pragma once
+
+// @Note: Body of the sprite kernels, shared by every SIMD width. W wraps the intrinsics of one instruction set:
+// lanes, F (register), load, store, set1, add, sub, mul, min, max and round (to nearest), plus the packing of one
+// sprite: half4 and unorm8x4 (see the packed Data_Types).
+// Included only by the kernel translation units, each one compiled for its own instruction set.
+
+// @Note: sin(x) for any x. Reduced to [-pi, pi], folded to [-pi/2, pi/2], then Taylor up to x^11 (error ~6e-8).
+template<typename W>
+inline fn wide_sin(typename W::F x) -> typename W::F {
+    using F = typename W::F;
+    const F pi = W::set1(3.14159265f);
+    const F two_pi = W::set1(6.28318531f);
+    const F inv_two_pi = W::set1(0.159154943f);
+
+    x = W::sub(x, W::mul(W::round(W::mul(x, inv_two_pi)), two_pi));
+    x = W::min(x, W::sub(pi, x));
+    x = W::max(x, W::sub(W::set1(-3.14159265f), x));
+
+    F x2 = W::mul(x, x);
+    F p = W::set1(-2.50521084e-8f);
+    p = W::add(W::mul(p, x2), W::set1(2.75573192e-6f));
+    p = W::add(W::mul(p, x2), W::set1(-1.98412698e-4f));
+    p = W::add(W::mul(p, x2), W::set1(8.33333333e-3f));
+    p = W::add(W::mul(p, x2), W::set1(-1.66666667e-1f));
+    p = W::mul(W::mul(p, x2), x);
+    return W::add(p, x);
+}
+
+// @Note: The 4 corners of W sprites, by corner and lane. The SIMD part is the trig and the affine, the rest is
+// writing the vertex layout lane by lane.
+template<typename W>
+struct Wide_Quads {
+    alignas(32) f32 x[4][W::lanes];
+    alignas(32) f32 y[4][W::lanes];
+    alignas(32) f32 basis[4][W::lanes]; // a, b (x axis) and c, d (y axis).
+};
+
+template<typename W>
+inline fn wide_quads(const Sprite_Soa& in, s32 i, Wide_Quads<W>* out) -> void {
+    using F = typename W::F;
+    const F half = W::set1(0.5f);
+
+    F rot = W::load(in.rot + i);
+    F sin = wide_sin<W>(rot);
+    F cos = wide_sin<W>(W::add(rot, W::set1(1.57079633f)));
+    F sx = W::load(in.scl_x + i);
+    F sy = W::load(in.scl_y + i);
+
+    F a = W::mul(cos, sx);
+    F b = W::mul(sin, sx);
+    F c = W::sub(W::set1(0.0f), W::mul(sin, sy));
+    F d = W::mul(cos, sy);
+    W::store(out->basis[0], a);
+    W::store(out->basis[1], b);
+    W::store(out->basis[2], c);
+    W::store(out->basis[3], d);
+
+    F px = W::load(in.pos_x + i);
+    F py = W::load(in.pos_y + i);
+    F ha = W::mul(a, half);
+    F hb = W::mul(b, half);
+    F hc = W::mul(c, half);
+    F hd = W::mul(d, half);
+
+    // Corners: (-, -), (+, -), (+, +), (-, +).
+    W::store(out->x[0], W::sub(W::sub(px, ha), hc));
+    W::store(out->y[0], W::sub(W::sub(py, hb), hd));
+    W::store(out->x[1], W::sub(W::add(px, ha), hc));
+    W::store(out->y[1], W::sub(W::add(py, hb), hd));
+    W::store(out->x[2], W::add(W::add(px, ha), hc));
+    W::store(out->y[2], W::add(W::add(py, hb), hd));
+    W::store(out->x[3], W::add(W::sub(px, ha), hc));
+    W::store(out->y[3], W::add(W::sub(py, hb), hd));
+}
+
+// @Note: Returns how many sprites it wrote, the tail (less than W::lanes) is left to the scalar kernel.
+template<typename W>
+inline fn wide_sprite_vertices(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Vertex* out) -> s32 {
+    constexpr s32 corner_u[] = { 0, 1, 1, 0 };
+    constexpr s32 corner_v[] = { 0, 0, 1, 1 };
+    constexpr Vec4 full_rect = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    Wide_Quads<W> quads;
+    s32 done = 0;
+    for (; done + W::lanes <= count; done += W::lanes) {
+        s32 i = first + done;
+        wide_quads<W>(in, i, &quads);
+
+        for (s32 lane = 0; lane < W::lanes; ++lane) {
+            Vec4 rect = in.uv_rect ? in.uv_rect[i + lane] : full_rect;
+            u32 tint = in.tint ? W::unorm8x4(in.tint[i + lane]) : 0xFFFFFFFFu;
+            f32 z = in.pos_z ? in.pos_z[i + lane] : 0.0f;
+
+            // @Note: The 4 corners share their uvs two by two: u0, u1, v0, v1.
+            Half4 edges = W::half4({ rect.x, rect.x + rect.z, rect.y, rect.y + rect.w });
+            u16 u[2] = { edges.x, edges.y };
+            u16 v[2] = { edges.z, edges.w };
+
+            Sprite_Vertex* verts = out + (done + lane) * 4;
+            for (s32 corner = 0; corner < 4; ++corner) {
+                Sprite_Vertex& vertex = verts[corner];
+                vertex.pos      = { quads.x[corner][lane], quads.y[corner][lane], z };
+                vertex.uv       = { u[corner_u[corner]], v[corner_v[corner]] };
+                vertex.tint     = tint;
+                vertex.tex_unit = tex_unit;
+            }
+        }
+    }
+    return done;
+}
+
+template<typename W>
+inline fn wide_sprite_instances(const Sprite_Soa& in, s32 first, s32 count, s32 tex_unit, Sprite_Instance* out) -> s32 {
+    constexpr Vec4 full_rect = { 0.0f, 0.0f, 1.0f, 1.0f };
+
+    Wide_Quads<W> quads;
+    s32 done = 0;
+    for (; done + W::lanes <= count; done += W::lanes) {
+        s32 i = first + done;
+        wide_quads<W>(in, i, &quads);
+
+        for (s32 lane = 0; lane < W::lanes; ++lane) {
+            Sprite_Instance& inst = out[done + lane];
+            inst.basis    = { quads.basis[0][lane], quads.basis[1][lane], quads.basis[2][lane], quads.basis[3][lane] };
+            inst.origin   = { in.pos_x[i + lane], in.pos_y[i + lane], in.pos_z ? in.pos_z[i + lane] : 0.0f };
+            inst.uv_rect  = W::half4(in.uv_rect ? in.uv_rect[i + lane] : full_rect);
+            inst.tint     = in.tint ? W::unorm8x4(in.tint[i + lane]) : 0xFFFFFFFFu;
+            inst.tex_unit = tex_unit;
+        }
+    }
+    return done;
+}
@@ -81,7 +81,7 @@ struct Entity {
     Vec3 scl = F32.One;
     Vec4 tint = Color.White;
     s32  sprite = 0;
-    struct Texture* tex = nullptr; // @Pending: This should be an asset handle.
+    const struct Texture* tex = nullptr; // @Pending: This should be an asset handle.
 };
 
 fn serialize(Serializer* s, const Entity& e) -> void;
@@ -190,14 +190,17 @@ struct Entity_Handle {
 // Entity_Storage: Entity manager.
 struct Entity_Storage {
     #define DeclareStorageVar(EntityType) \
-        Fixed_Handle_Array<EntityType> EntityStorage(EntityType);
+        Handle_Pool<EntityType> EntityStorage(EntityType);
         
         ForEntityTypes(DeclareStorageVar)
 
     #undef DeclareStorageVar
 };
 
-fn entity_storage_init() -> void;
+// @Note: The storages (and the records in them) take their memory from allocator, the heap if null. A pool
+// (base_pool.h) keeps them together. They grow a page at a time (see base_handle_pool.h), so there's no cap on
+// the entities of a kind and an Entity* stays good until its entity is destroyed.
+fn entity_storage_init(Allocator* allocator = nullptr) -> void;
 fn entity_storage_done() -> void;
 fn entity_create(Entity_Kind kind) -> Entity_Handle;
 fn entity_destroy(Entity_Handle handle) -> void; // @Pending: Save the entities to a cleanup list and wait till the frame ends.
@@ -216,14 +219,21 @@ fn entity_pass(void (*update)(Entity*)) -> void;
 #ifdef ENTITY_IMPL
 
 static Entity_Storage* world = nullptr;
+static Allocator* world_allocator = nullptr;
 
-fn entity_storage_init() -> void {
+fn entity_storage_init(Allocator* allocator) -> void {
 
     if (world) {
         entity_storage_done();
     }
     
-    world = new Entity_Storage();
+    world_allocator = allocator;
+    world = new (mem_alloc(allocator, sizeof(Entity_Storage), alignof(Entity_Storage))) Entity_Storage();
+    #define SetAllocator(EntityType) \
+        world->EntityStorage(EntityType).allocator = allocator;
+
+        ForEntityTypes(SetAllocator)
+    #undef SetAllocator
 }
 
 fn entity_storage_done() -> void {
@@ -236,8 +246,10 @@ fn entity_storage_done() -> void {
         ForEntityTypes(FreeStorage)
     #undef FreeStorage
 
-    delete world;
+    world->~Entity_Storage();
+    mem_free(world_allocator, world, sizeof(Entity_Storage));
     world = nullptr;
+    world_allocator = nullptr;
 }
 
 fn entity_create(Entity_Kind kind) -> Entity_Handle {
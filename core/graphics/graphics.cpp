@@ -3,50 +3,306 @@
 #include "os_core.h"
 #include "io_image.h"
 
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+// @Note: Mirror of the gl state we touch, so we can skip the calls that wouldn't change anything.
+// Everything starts at the gl defaults. The blend state starts unknown.
+struct Gl_State {
+    static constexpr u32 max_units = 32u;
+    u32 pgm = 0u;
+    u32 vao = 0u;
+    u32 tex[max_units] = {};
+    struct {
+        u32 buf = 0u;
+        s32 offset = 0;
+        s32 size = 0; // 0 means the whole buffer (glBindBufferBase).
+    } ubo;
+    s32 blend = -1; // -1 unknown, 0 disabled, 1 enabled.
+};
+
+static Gl_State g_state;
+static Graphics_Stats g_stats;
+static Graphics_Backend g_backend = Graphics_Backend::GL;
+static Graphics_Recording g_recording;
+static u32 g_recording_names = 0u;
+
+static fn is_recording() -> bool {
+    return g_backend == Graphics_Backend::Recording;
+}
+
+// @Note: Stands for the glCreate* of the recording backend. Never 0, so the validity checks keep working.
+static fn recording_name() -> u32 {
+    return ++g_recording_names;
+}
+
+static fn record(Graphics_Cmd cmd, s64 bytes = 0, s64 count = 0) -> void {
+    if (!is_recording()) {
+        return;
+    }
+    ++g_recording.calls[(s32) cmd];
+    g_recording.bytes += bytes;
+
+    if (g_recording.serialize) {
+        Serializer* s = &g_recording.commands;
+        serialize_block_init(s);
+        serialize_field(s, "cmd", to_string(cmd));
+        if (bytes) {
+            serialize_field(s, "bytes", bytes);
+        }
+        if (count) {
+            serialize_field(s, "count", count);
+        }
+        serialize_block_done(s);
+    }
+}
+
+fn to_string(Graphics_Cmd cmd) -> const char* {
+    switch (cmd) {
+        #define DeclareCaseEntry(name) \
+            case Graphics_Cmd::name: return Stringify(name);
+
+            FOR_GRAPHICS_CMDS(DeclareCaseEntry)
+        #undef DeclareCaseEntry
+
+        default: return "";
+    }
+}
+
+fn graphics_set_backend(Graphics_Backend backend, bool serialize) -> void {
+    g_backend = backend;
+    graphics_reset_recording();
+    g_recording.serialize = serialize;
+    graphics_invalidate_state();
+}
+
+fn graphics_backend() -> Graphics_Backend {
+    return g_backend;
+}
+
+fn graphics_recording() -> const Graphics_Recording& {
+    return g_recording;
+}
+
+fn graphics_reset_recording() -> void {
+    bool serialize = g_recording.serialize;
+    g_recording = {};
+    g_recording.serialize = serialize;
+}
+
+static fn state_use_program(u32 pgm) -> void {
+    if (g_state.pgm == pgm) {
+        ++g_stats.elided;
+        return;
+    }
+    g_state.pgm = pgm;
+    ++g_stats.issued;
+    record(Graphics_Cmd::Use_Program);
+    if (!is_recording()) {
+        glUseProgram(pgm);
+    }
+}
+
+static fn state_bind_vertex_array(u32 vao) -> void {
+    if (g_state.vao == vao) {
+        ++g_stats.elided;
+        return;
+    }
+    g_state.vao = vao;
+    ++g_stats.issued;
+    record(Graphics_Cmd::Bind_Vertex_Array);
+    if (!is_recording()) {
+        glBindVertexArray(vao);
+    }
+}
+
+static fn state_bind_texture_unit(u32 unit, u32 tex) -> void {
+    if (unit < g_state.max_units && g_state.tex[unit] == tex) {
+        ++g_stats.elided;
+        return;
+    }
+    if (unit < g_state.max_units) {
+        g_state.tex[unit] = tex;
+    }
+    ++g_stats.issued;
+    record(Graphics_Cmd::Bind_Texture, 0, unit);
+    if (!is_recording()) {
+        glBindTextureUnit(unit, tex);
+    }
+}
+
+static fn state_bind_uniform_buffer(u32 buf, s32 offset, s32 size) -> void {
+    auto& ubo = g_state.ubo;
+    if (ubo.buf == buf && ubo.offset == offset && ubo.size == size) {
+        ++g_stats.elided;
+        return;
+    }
+    ubo.buf = buf;
+    ubo.offset = offset;
+    ubo.size = size;
+    ++g_stats.issued;
+    record(Graphics_Cmd::Bind_Uniform_Buffer);
+    if (is_recording()) {
+        return;
+    }
+    if (size == 0) {
+        glBindBufferBase(GL_UNIFORM_BUFFER, /* index */ 0, buf);
+    } else {
+        glBindBufferRange(GL_UNIFORM_BUFFER, /* index */ 0, buf, offset, size);
+    }
+}
+
+// @Note: Called when a gl object dies. Gl reuses the names, a stale entry would skip a real bind.
+static fn state_forget_program(u32 pgm) -> void {
+    if (g_state.pgm == pgm) {
+        g_state.pgm = 0u;
+    }
+}
+
+static fn state_forget_vertex_array(u32 vao) -> void {
+    if (g_state.vao == vao) {
+        g_state.vao = 0u;
+    }
+}
+
+static fn state_forget_texture(u32 tex) -> void {
+    for (u32& it : g_state.tex) {
+        if (it == tex) {
+            it = 0u;
+        }
+    }
+}
+
+static fn state_forget_buffer(u32 buf) -> void {
+    if (g_state.ubo.buf == buf) {
+        g_state.ubo = {};
+    }
+}
+
+fn graphics_stats() -> Graphics_Stats {
+    return g_stats;
+}
+
+fn graphics_reset_stats() -> void {
+    g_stats = {};
+}
+
+fn graphics_invalidate_state() -> void {
+    // @Note: Unknown values, so the next request of each state always goes through.
+    g_state.pgm = U32.Max;
+    g_state.vao = U32.Max;
+    for (u32& it : g_state.tex) {
+        it = U32.Max;
+    }
+    g_state.ubo.buf = U32.Max;
+    g_state.blend = -1;
+}
+
 fn clear_back_buffer(Vec4 color) -> void {
+    if (is_recording()) {
+        record(Graphics_Cmd::Clear);
+        return;
+    }
     os_clear_color_gl(color);
     glClear(GL_COLOR_BUFFER_BIT);
 }
 
 fn ser_blend_enabled(bool enabled) -> void {
+    if (g_state.blend == (s32) enabled) {
+        ++g_stats.elided;
+        return;
+    }
+    g_state.blend = enabled;
+    ++g_stats.issued;
+    if (is_recording()) {
+        record(Graphics_Cmd::Blend);
+        return;
+    }
     if (enabled) {
         glEnable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     } else {
         glDisable(GL_BLEND);
-        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
     }
 }
 
-fn vertex_buffer_init(Vertex_Buffer* obj, Vertex_Buffer_Def def) -> void {
-
-    auto &[vao, ebo, vbo, _] = *obj;
-
-    glCreateVertexArrays(1, &vao);
-    
+// @Note: Returns the stride (size of all the attributes together).
+static fn vertex_buffer_set_attrs(u32 vao, Attr_View attrs, u32 first_location, u32 binding) -> s32 {
     s32 offset = 0;
-    
-    // Process the attributes.
-    for (s32 i = 0; i < def.attrs.count; ++i) {
-        Data_Type attr = def.attrs.data[i];
+    for (s32 i = 0; i < attrs.count; ++i) {
+        Data_Type attr = attrs.data[i];
         if (!os_is_gl_attribute(attr)) {
             continue;
         }
-        glEnableVertexArrayAttrib(vao, i);
+        u32 location = first_location + i;
+        if (is_recording()) {
+            offset += get_size(attr);
+            continue;
+        }
+        glEnableVertexArrayAttrib(vao, location);
         if (!is_integer_type(attr)) {
-            glVertexArrayAttribFormat(vao, i, get_count(attr), os_to_gl(attr), false, offset);
+            glVertexArrayAttribFormat(vao, location, get_count(attr), os_to_gl(attr), is_normalized_type(attr), offset);
         } else {
-            glVertexArrayAttribIFormat(vao, i, get_count(attr), os_to_gl(attr), offset);
+            glVertexArrayAttribIFormat(vao, location, get_count(attr), os_to_gl(attr), offset);
         }
-        glVertexArrayAttribBinding(vao, i, /* vbo binding */ 0u);
+        glVertexArrayAttribBinding(vao, location, binding);
         offset += get_size(attr);
     }
+    return offset;
+}
+
+fn vertex_buffer_init(Vertex_Buffer* obj, Vertex_Buffer_Def def) -> void {
+
+    auto &[vao, ebo, vbo, _, inst_vbo, stride, inst_stride] = *obj;
+
+    if (is_recording()) {
+        vao = recording_name();
+        ebo = recording_name();
+        stride = vertex_buffer_set_attrs(vao, def.attrs, 0u, 0u);
+        if (def.verts.size > 0) {
+            vbo = recording_name();
+            stride = def.verts.size / def.verts.count;
+        }
+        if (def.inst_attrs.count > 0) {
+            inst_stride = vertex_buffer_set_attrs(vao, def.inst_attrs, def.attrs.count, 1u);
+            if (def.insts.size > 0) {
+                inst_vbo = recording_name();
+                inst_stride = def.insts.size / def.insts.count;
+            }
+        }
+        obj->elem_count = def.elems.count;
+        record(Graphics_Cmd::Vertex_Buffer_Init, (s64) def.verts.size + def.insts.size + def.elems.count * sizeof(u32));
+        return;
+    }
+
+    glCreateVertexArrays(1, &vao);
+    
+    // Process the attributes.
+    stride = vertex_buffer_set_attrs(vao, def.attrs, /* first location */ 0u, /* vbo binding */ 0u);
+
+    // Create the vertex buffer and send the data. (Streamed buffers get it later, see vertex_buffer_set_source).
+    if (def.verts.size > 0) {
+        glCreateBuffers(1, &vbo);
+        GLenum usage = def.verts.data ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+        glNamedBufferData(vbo, def.verts.size, def.verts.data, usage);
+        stride = def.verts.size / def.verts.count;
+        glVertexArrayVertexBuffer(vao, /* vbo binding */ 0, vbo, /* offset */ 0, stride);
+    }
 
-    // Create the vertex buffer and send the data.
-    glCreateBuffers(1, &vbo);
-    GLenum usage = def.verts.data ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
-    glNamedBufferData(vbo, def.verts.size, def.verts.data, usage);
-    glVertexArrayVertexBuffer(vao, /* vbo binding */ 0, vbo, /* offset */ 0, def.verts.size / def.verts.count);
+    // Create the instance buffer (if any) and send the data.
+    if (def.inst_attrs.count > 0) {
+        inst_stride = vertex_buffer_set_attrs(vao, def.inst_attrs, /* first location */ def.attrs.count, /* inst binding */ 1u);
+        if (def.insts.size > 0) {
+            glCreateBuffers(1, &inst_vbo);
+            GLenum inst_usage = def.insts.data ? GL_STATIC_DRAW : GL_DYNAMIC_DRAW;
+            glNamedBufferData(inst_vbo, def.insts.size, def.insts.data, inst_usage);
+            inst_stride = def.insts.size / def.insts.count;
+            glVertexArrayVertexBuffer(vao, /* inst binding */ 1, inst_vbo, /* offset */ 0, inst_stride);
+        }
+        glVertexArrayBindingDivisor(vao, /* inst binding */ 1, /* advance every */ 1);
+    }
 
     // Create the element buffer.
     glCreateBuffers(1, &ebo);
@@ -56,133 +312,696 @@ fn vertex_buffer_init(Vertex_Buffer* obj, Vertex_Buffer_Def def) -> void {
 }
 
 fn vertex_buffer_done(Vertex_Buffer* obj) -> void {
-    auto &[vao, ebo, vbo, _] = *obj;
+    auto &[vao, ebo, vbo, _, inst_vbo, stride, inst_stride] = *obj;
+    if (is_recording()) {
+        record(Graphics_Cmd::Vertex_Buffer_Done);
+        state_forget_vertex_array(vao);
+        *obj = {};
+        return;
+    }
     glDeleteBuffers(1, &vbo);
     glDeleteBuffers(1, &ebo);
+    if (inst_vbo) {
+        glDeleteBuffers(1, &inst_vbo);
+    }
     glDeleteVertexArrays(1, &vao);
+    state_forget_vertex_array(vao);
     *obj = {};
 }
 
 fn vertex_buffer_draw(Vertex_Buffer obj) -> void {
     checkf(obj.vao != 0u, "Error! This is not a valid Vertex Array!");
-    glBindVertexArray(obj.vao);
+    state_bind_vertex_array(obj.vao);
+    if (is_recording()) {
+        record(Graphics_Cmd::Draw, 0, obj.elem_count);
+        return;
+    }
     glDrawElements(GL_TRIANGLES, obj.elem_count, GL_UNSIGNED_INT, nullptr);
 }
 
+fn vertex_buffer_draw(Vertex_Buffer obj, s32 elem_count) -> void {
+    checkf(obj.vao != 0u, "Error! This is not a valid Vertex Array!");
+    checkf(elem_count <= obj.elem_count, "Error! Drawing more elements than the buffer has!");
+    state_bind_vertex_array(obj.vao);
+    if (is_recording()) {
+        record(Graphics_Cmd::Draw, 0, elem_count);
+        return;
+    }
+    glDrawElements(GL_TRIANGLES, elem_count, GL_UNSIGNED_INT, nullptr);
+}
+
+fn vertex_buffer_update(Vertex_Buffer obj, const void* data, s32 size) -> void {
+    checkf(obj.vbo != 0u, "Error! This is not a valid Vertex Array!");
+    if (is_recording()) {
+        record(Graphics_Cmd::Vertex_Buffer_Update, size);
+        return;
+    }
+    glNamedBufferSubData(obj.vbo, /* offset */ 0, size, data);
+}
+
+fn vertex_buffer_update_instances(Vertex_Buffer obj, const void* data, s32 size) -> void {
+    checkf(obj.inst_vbo != 0u, "Error! This Vertex Array has no instance buffer!");
+    if (is_recording()) {
+        record(Graphics_Cmd::Vertex_Buffer_Update, size);
+        return;
+    }
+    glNamedBufferSubData(obj.inst_vbo, /* offset */ 0, size, data);
+}
+
+fn vertex_buffer_draw_instanced(Vertex_Buffer obj, s32 inst_count) -> void {
+    checkf(obj.vao != 0u, "Error! This is not a valid Vertex Array!");
+    state_bind_vertex_array(obj.vao);
+    if (is_recording()) {
+        record(Graphics_Cmd::Draw_Instanced, 0, inst_count);
+        return;
+    }
+    glDrawElementsInstanced(GL_TRIANGLES, obj.elem_count, GL_UNSIGNED_INT, nullptr, inst_count);
+}
+
+// @Note: Samplers and bools are uploaded as ints.
+static fn shader_param_value_size(Data_Type type) -> s32 {
+    if (type == Data_Type::Sampler2D || type == Data_Type::Sampler2DArray || type == Data_Type::Bool) {
+        return 4;
+    }
+    return get_size(type);
+}
+
+static fn shader_params_insert(Shader_Params* params, const Shader_Param& param) -> void {
+    u32 mask = params->cap - 1u;
+    u32 i = (u32) param.hash & mask;
+    while (params->table[i].hash != 0u) {
+        i = (i + 1u) & mask;
+    }
+    params->table[i] = param;
+}
+
+// @Note: Collects the active uniforms and uniform blocks of a linked program.
+static fn shader_reflect(u32 pgm) -> Shader_Params* {
+    GLint uniform_count = 0;
+    GLint block_count = 0;
+    glGetProgramiv(pgm, GL_ACTIVE_UNIFORMS, &uniform_count);
+    glGetProgramiv(pgm, GL_ACTIVE_UNIFORM_BLOCKS, &block_count);
+
+    auto* params = new Shader_Params();
+    params->cap = 8u;
+    while (params->cap < 2u * (u32) (uniform_count + block_count)) {
+        params->cap *= 2u;
+    }
+    params->table = new Shader_Param[params->cap]{};
+    params->uploaded = new bool[params->cap]{};
+
+    constexpr GLsizei max_name = 256;
+    GLchar name[max_name];
+    s32 values_size = 0;
+
+    for (GLint i = 0; i < uniform_count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(pgm, (GLuint) i, max_name, &length, &size, &type, name);
+
+        // @Note: Members of a uniform block don't have a location.
+        GLint location = glGetUniformLocation(pgm, name);
+        if (location < 0) {
+            continue;
+        }
+
+        std::string_view name_view(name, length);
+        if (name_view.size() > 3 && name_view.substr(name_view.size() - 3) == "[0]") {
+            name_view.remove_suffix(3);
+        }
+
+        Shader_Param param;
+        param.hash = hash_str(name_view);
+        param.kind = Shader_Param::Uniform;
+        param.type = os_from_gl(type);
+        param.location = location;
+        param.count = size;
+        param.value = values_size;
+        values_size += shader_param_value_size(param.type) * size;
+        shader_params_insert(params, param);
+    }
+
+    for (GLint i = 0; i < block_count; ++i) {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(pgm, (GLuint) i, max_name, &length, name);
+
+        GLint data_size = 0;
+        GLint binding = 0;
+        glGetActiveUniformBlockiv(pgm, (GLuint) i, GL_UNIFORM_BLOCK_DATA_SIZE, &data_size);
+        glGetActiveUniformBlockiv(pgm, (GLuint) i, GL_UNIFORM_BLOCK_BINDING, &binding);
+
+        Shader_Param param;
+        param.hash = hash_str(std::string_view(name, length));
+        param.kind = Shader_Param::Block;
+        param.location = i;
+        param.count = data_size;
+        param.binding = binding;
+        shader_params_insert(params, param);
+    }
+
+    params->values = new u8[values_size > 0 ? values_size : 1];
+    return params;
+}
+
+// @Note: Tries the program binary cache first. On a miss (or a rejected binary) it compiles and refreshes the cache.
+static fn shader_create_program(std::string_view source, Shader_Def def) -> u32 {
+    if (def.cache_dir.empty()) {
+        return os_create_gl_program(source, def.defines);
+    }
+
+    static const std::string driver = os_gl_driver_string();
+    u64 key = hash_str(driver, hash_str(def.defines, hash_str(source)));
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long) key);
+    std::string filename = std::string(def.cache_dir) + "/" + name;
+
+    std::string blob = os_read_entire_file(filename);
+    if (!blob.empty()) {
+        u32 pgm = os_create_gl_program_from_binary(blob);
+        if (pgm) {
+            return pgm;
+        }
+        logf("Shader cache: %s was rejected, compiling %s.", filename.c_str(), std::string(def.filename).c_str());
+    }
+
+    u32 pgm = os_create_gl_program(source, def.defines);
+    if (pgm && os_get_gl_program_binary(pgm, &blob) && os_make_dir(def.cache_dir)) {
+        os_write_entire_file(filename, blob);
+    }
+    return pgm;
+}
+
 fn shader_init(Shader* shader, Shader_Def def) -> void {
     std::string source = os_read_entire_file(def.filename);
     checkf(!source.empty(), "Error! This is not a valid Vertex Array!");
-    shader->pgm = os_create_gl_program(source);
+    // @Note: Without gl there is nothing to reflect, the params stay empty and the setters are only counted.
+    if (is_recording()) {
+        shader->pgm = recording_name();
+        record(Graphics_Cmd::Shader_Init, (s64) source.size());
+        return;
+    }
+    shader->pgm = shader_create_program(source, def);
+    if (shader->pgm) {
+        shader->params = shader_reflect(shader->pgm);
+    }
 }
 
 fn shader_done(Shader* shader) -> void {
-    glDeleteProgram(shader->pgm);
+    if (is_recording()) {
+        record(Graphics_Cmd::Shader_Done);
+    } else {
+        glDeleteProgram(shader->pgm);
+    }
+    state_forget_program(shader->pgm);
+    if (shader->params) {
+        delete[] shader->params->table;
+        delete[] shader->params->uploaded;
+        delete[] shader->params->values;
+        delete shader->params;
+    }
     *shader = {};
 }
 
 fn shader_use(Shader shader) -> void {
     checkf(shader.pgm != 0, "Error! This is not a valid Shader!");
-    glUseProgram(shader.pgm);
+    state_use_program(shader.pgm);
 }
 
-fn shader_set_param(Shader shader, std::string_view name, const s32* data, s32 count) -> void {
+fn shader_param(Shader shader, u64 hash) -> const Shader_Param* {
+    if (!shader.params) {
+        return nullptr;
+    }
+    const Shader_Params& params = *shader.params;
+    u32 mask = params.cap - 1u;
+    u32 i = (u32) hash & mask;
+    while (params.table[i].hash != 0u) {
+        if (params.table[i].hash == hash) {
+            return &params.table[i];
+        }
+        i = (i + 1u) & mask;
+    }
+    return nullptr;
+}
+
+// @Note: Compares against the last uploaded value and keeps the new one. Returns if we have to upload.
+static fn shader_param_changed(Shader shader, const Shader_Param* param, const void* data, s32 count) -> bool {
+    checkf(param->kind == Shader_Param::Uniform, "Error! Uniform blocks are set through a Global_Buffer!");
+    checkf(count <= param->count, "Error! Setting %i elements of a uniform with %i!", count, param->count);
+
+    Shader_Params& params = *shader.params;
+    u32 slot = (u32) (param - params.table);
+    u8* value = params.values + param->value;
+    s32 size = shader_param_value_size(param->type) * count;
+
+    if (params.uploaded[slot] && memcmp(value, data, size) == 0) {
+        ++g_stats.elided;
+        return false;
+    }
+
+    memcpy(value, data, size);
+    params.uploaded[slot] = true;
+    ++g_stats.issued;
+    return true;
+}
+
+fn shader_set_param(Shader shader, const Shader_Param* param, const s32* data, s32 count) -> void {
+    checkf(shader.pgm != 0, "Error! This is not a valid Shader!");
+    if (is_recording()) {
+        record(Graphics_Cmd::Shader_Set_Param, count * sizeof(s32), count);
+        return;
+    }
+    if (!param || !shader_param_changed(shader, param, data, count)) {
+        return;
+    }
+    switch (param->type) {
+        case Data_Type::Int:
+        case Data_Type::Bool:
+        case Data_Type::Sampler2D:
+        case Data_Type::Sampler2DArray: glProgramUniform1iv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Int2:      glProgramUniform2iv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Int3:      glProgramUniform3iv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Int4:      glProgramUniform4iv(shader.pgm, param->location, count, data); break;
+        default: checkf(false, "Error! This uniform is not an integer type!");
+    }
+}
+
+fn shader_set_param(Shader shader, const Shader_Param* param, const f32* data, s32 count) -> void {
     checkf(shader.pgm != 0, "Error! This is not a valid Shader!");
-    GLint location = glGetUniformLocation(shader.pgm, name.data());
-    glUniform1iv(location, count, data);
+    if (is_recording()) {
+        record(Graphics_Cmd::Shader_Set_Param, count * sizeof(f32), count);
+        return;
+    }
+    if (!param || !shader_param_changed(shader, param, data, count)) {
+        return;
+    }
+    switch (param->type) {
+        case Data_Type::Float:  glProgramUniform1fv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Float2: glProgramUniform2fv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Float3: glProgramUniform3fv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Float4: glProgramUniform4fv(shader.pgm, param->location, count, data); break;
+        case Data_Type::Mat3:   glProgramUniformMatrix3fv(shader.pgm, param->location, count, false, data); break;
+        case Data_Type::Mat4:   glProgramUniformMatrix4fv(shader.pgm, param->location, count, false, data); break;
+        default: checkf(false, "Error! This uniform is not a float type!");
+    }
+}
+
+fn shader_set_param(Shader shader, std::string_view name, const s32* data, s32 count) -> void {
+    shader_set_param(shader, shader_param(shader, hash_str(name)), data, count);
 }
 
 fn global_buffer_init(Global_Buffer* obj, Global_Buffer_Def def) -> void {
+    if (is_recording()) {
+        obj->gbo = recording_name();
+        obj->size = def.size;
+        record(Graphics_Cmd::Global_Buffer_Init);
+        return;
+    }
     glCreateBuffers(1, &obj->gbo);
     glNamedBufferData(obj->gbo, def.size, nullptr, GL_DYNAMIC_DRAW);
     obj->size = def.size;    
 }
 
 fn global_buffer_done(Global_Buffer* obj) -> void {
-    glDeleteBuffers(1, &obj->gbo);
+    if (is_recording()) {
+        record(Graphics_Cmd::Global_Buffer_Done);
+    } else {
+        glDeleteBuffers(1, &obj->gbo);
+    }
+    state_forget_buffer(obj->gbo);
     *obj = {};
 }
 
 fn global_buffer_use(Global_Buffer obj) -> void {
     checkf(obj.gbo != 0u, "Error! This is not a valid Global Buffer!");
-    glBindBufferBase(GL_UNIFORM_BUFFER, /* index */ 0, obj.gbo);
+    state_bind_uniform_buffer(obj.gbo, /* offset */ 0, /* whole buffer */ 0);
 }
 
 fn global_buffer_update(Global_Buffer obj, const void* data) -> void {
     checkf(obj.gbo != 0u, "Error! This is not a valid Global Buffer!");
+    if (is_recording()) {
+        record(Graphics_Cmd::Global_Buffer_Update, obj.size);
+        return;
+    }
     glNamedBufferSubData(obj.gbo, /* offset */ 0, obj.size, data);
 }
 
-fn texture_init(Texture* texture, Texture_Def def) -> void {
-    
-    IO_Image image_buff;
-    const IO_Image* image = nullptr;
-    if (def.image) {
-       image = def.image; 
+fn stream_buffer_init(Stream_Buffer* obj, Stream_Buffer_Def def) -> void {
+    checkf(def.regions > 0 && def.regions <= Stream_Buffer::max_regions, "Error! Invalid Stream Buffer region count!");
+
+    obj->region_size = def.size;
+    obj->region_count = def.regions;
+    obj->region = 0;
+    obj->head = 0;
+    obj->stats = {};
+
+    s32 size = def.size * def.regions;
+
+    // @Note: Plain memory, there is no gpu to wait for.
+    if (is_recording()) {
+        obj->buf = recording_name();
+        obj->mapped = new u8[size];
+        obj->uniform_align = 256;
+        record(Graphics_Cmd::Stream_Buffer_Init);
+        return;
+    }
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers(1, &obj->buf);
+    glNamedBufferStorage(obj->buf, size, nullptr, flags);
+    obj->mapped = (u8*) glMapNamedBufferRange(obj->buf, /* offset */ 0, size, flags);
+    checkf(obj->mapped, "Error! Failed to map the Stream Buffer!");
+
+    GLint uniform_align = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_align);
+    obj->uniform_align = uniform_align;
+}
+
+fn stream_buffer_done(Stream_Buffer* obj) -> void {
+    if (is_recording()) {
+        record(Graphics_Cmd::Stream_Buffer_Done);
+        delete[] obj->mapped;
+        *obj = {};
+        return;
+    }
+    for (void*& fence : obj->fences) {
+        if (fence) {
+            glDeleteSync((GLsync) fence);
+        }
+    }
+    if (obj->buf) {
+        glUnmapNamedBuffer(obj->buf);
+        glDeleteBuffers(1, &obj->buf);
+        state_forget_buffer(obj->buf);
+    }
+    *obj = {};
+}
+
+static fn stream_buffer_next_region(Stream_Buffer* obj) -> void {
+
+    // @Note: Everything that reads the current region has already been submitted.
+    if (is_recording()) {
+        record(Graphics_Cmd::Stream_Buffer_Fence);
     } else {
-        io_image_load(def.filename, &image_buff);
-        image = &image_buff;
+        obj->fences[obj->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
     }
-    checkf(io_image_valid(*image), "Error! This is not a valid Image!");
+    obj->region = (obj->region + 1) % obj->region_count;
+    obj->head = 0;
+    ++obj->stats.region_switches;
+
+    GLsync fence = (GLsync) obj->fences[obj->region];
+    if (!fence) {
+        return;
+    }
+
+    GLenum result = glClientWaitSync(fence, 0, /* timeout */ 0);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        ++obj->stats.stalls;
+        f64 start = os_get_time();
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, /* 1 second */ 1000000000);
+        } while (result == GL_TIMEOUT_EXPIRED);
+        obj->stats.stall_seconds += os_get_time() - start;
+    }
+    checkf(result != GL_WAIT_FAILED, "Error! Waiting for the Stream Buffer fence failed!");
+
+    glDeleteSync(fence);
+    obj->fences[obj->region] = nullptr;
+}
+
+fn stream_buffer_map(Stream_Buffer* obj, s32 size, s32 align) -> Stream_Alloc {
+    checkf(obj->mapped, "Error! This is not a valid Stream Buffer!");
+    if (!ensuref(size <= obj->region_size, "Error! Stream allocation of %i bytes, regions are %i bytes!", size, obj->region_size)) {
+        return {};
+    }
+
+    s32 offset = (obj->head + align - 1) / align * align;
+    if (offset + size > obj->region_size) {
+        stream_buffer_next_region(obj);
+        offset = 0;
+    }
+
+    offset += obj->region * obj->region_size;
+    return { obj->mapped + offset, offset, size };
+}
+
+fn stream_buffer_commit(Stream_Buffer* obj, Stream_Alloc alloc, s32 used) -> void {
+    checkf(used <= alloc.size, "Error! Committing more bytes than mapped!");
+    obj->head = alloc.offset - obj->region * obj->region_size + used;
+    ++obj->stats.allocs;
+    obj->stats.bytes += used;
+    record(Graphics_Cmd::Stream_Buffer_Commit, used);
+}
+
+fn stream_buffer_alloc(Stream_Buffer* obj, s32 size, s32 align) -> Stream_Alloc {
+    Stream_Alloc alloc = stream_buffer_map(obj, size, align);
+    if (alloc.data) {
+        stream_buffer_commit(obj, alloc, size);
+    }
+    return alloc;
+}
+
+fn stream_buffer_reset_stats(Stream_Buffer* obj) -> void {
+    obj->stats = {};
+}
+
+fn global_buffer_use(const Stream_Buffer& obj, Stream_Alloc range) -> void {
+    checkf(obj.buf != 0u, "Error! This is not a valid Stream Buffer!");
+    state_bind_uniform_buffer(obj.buf, range.offset, range.size);
+}
+
+fn vertex_buffer_set_source(Vertex_Buffer obj, const Stream_Buffer& stream, s32 offset) -> void {
+    checkf(obj.vao != 0u, "Error! This is not a valid Vertex Array!");
+    if (is_recording()) {
+        record(Graphics_Cmd::Vertex_Buffer_Source);
+        return;
+    }
+    glVertexArrayVertexBuffer(obj.vao, /* vbo binding */ 0, stream.buf, offset, obj.stride);
+}
+
+fn vertex_buffer_set_instance_source(Vertex_Buffer obj, const Stream_Buffer& stream, s32 offset) -> void {
+    checkf(obj.vao != 0u, "Error! This is not a valid Vertex Array!");
+    if (is_recording()) {
+        record(Graphics_Cmd::Vertex_Buffer_Source);
+        return;
+    }
+    glVertexArrayVertexBuffer(obj.vao, /* inst binding */ 1, stream.buf, offset, obj.inst_stride);
+}
+
+static fn build_cells(Subtex_Array* cells, s32 width, s32 height, s32 tile_size) -> void {
+    if (!ensuref(tile_size > 0 && tile_size <= width && tile_size <= height, "Error! Invalid tile_size!")) {
+        return;
+    }
+    s32 x_count = width  / tile_size;
+    s32 y_count = height / tile_size;
+    s32 cell_count = x_count * y_count;
+
+    if (!ensuref(cell_count <= cells->max, "Error! Cell count is %i. Max allowed is %i", cell_count, cells->max)) {
+        return;
+    }
+
+    cells->count = cell_count;
+
+    for (s32 i = 0; i < cell_count; ++i) {
+        s32 x_offset = i / y_count;
+        s32 y_offset = i % y_count;
+
+        auto &cell = cells->data[i];
+        cell.width = tile_size;
+        cell.height = tile_size;
+        cell.x = tile_size * x_offset;
+        cell.y = tile_size * y_offset;
+    }
+}
+
+static fn texture_filter(Texture_Filter filter) -> GLenum {
+    return filter == Texture_Filter::Nearest ? GL_NEAREST :
+           filter == Texture_Filter::Linear  ? GL_LINEAR  : 0;
+}
+
+// @Note: Every texture is premultiplied (see ser_blend_enabled). The images we loaded change in place, the ones
+// from outside get copied first.
+static fn premultiply_image(IO_Image* image) -> void {
+    if (image->channels != 4 || image->premultiplied) {
+        return;
+    }
+    if (!image->is_owner) {
+        u64 size = (u64) image->width * image->height * 4;
+        image->block = io_storage_alloc(size);
+        memcpy(image->block.data, image->data, size);
+        image->data = image->block.data;
+        image->is_owner = true;
+    }
+    io_image_premultiply(image);
+}
+
+// @Note: Every tile of every sheet becomes a layer. The tiles follow the Tileset cell order.
+static fn texture_init_array(Texture* texture, Texture_Def def) -> void {
+
+    std::string_view single[] = { def.filename };
+    const std::string_view* filenames = def.filenames ? def.filenames : single;
+    s32 file_count = def.filenames ? def.filename_count : 1;
+    s32 tile = def.tile_size;
+
+    IO_Image* images = new IO_Image[file_count];
+    s32 layers = 0;
+
+    // @Note: Every sheet decodes at the same time on the job pool.
+    IO_Image_Ticket* tickets = new IO_Image_Ticket[file_count];
+    bool from_image = def.image && !def.filenames;
+    for (s32 i = 0; !from_image && i < file_count; ++i) {
+        tickets[i] = io_image_load_async(filenames[i]);
+    }
+
+    for (s32 i = 0; i < file_count; ++i) {
+        if (from_image) {
+            images[i] = *def.image;
+            images[i].is_owner = false;
+        } else {
+            io_image_wait(tickets[i], &images[i]);
+        }
+        if (!def.premultiplied) {
+            premultiply_image(&images[i]);
+        }
+        checkf(io_image_valid(images[i]), "Error! This is not a valid Image!");
+        checkf(images[i].channels == images[0].channels, "Error! The sheets of an array must share the channels!");
+        checkf(tile > 0 && tile <= images[i].width && tile <= images[i].height, "Error! Invalid tile_size!");
+        layers += (images[i].width / tile) * (images[i].height / tile);
+    }
+    delete[] tickets;
 
     u32& tex = texture->tex;
-    texture->width = image->width;
-    texture->height = image->height;
+    texture->width = tile;
+    texture->height = tile;
+    texture->layers = layers;
+    texture->kind = Texture_Kind::Array;
+
+    if (is_recording()) {
+        tex = recording_name();
+        record(Graphics_Cmd::Texture_Init, (s64) tile * tile * images[0].channels * layers, layers);
+        for (s32 i = 0; i < file_count; ++i) {
+            if (images[i].is_owner) {
+                io_image_free(&images[i]);
+            }
+        }
+        delete[] images;
+        return;
+    }
+
+    glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &tex);
+
+    s32 channels = images[0].channels;
+    s32 storage_format = channels == 4 ? GL_RGBA8 : channels == 3 ? GL_RGB8 : 0;
+    s32 data_format    = channels == 4 ? GL_RGBA  : channels == 3 ? GL_RGB  : 0;
+
+    glTextureStorage3D(tex, 1, storage_format, tile, tile, layers);
+
+    GLenum filter = texture_filter(def.filter);
+    glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, filter);
+    glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, filter);
+    glTextureParameteri(tex, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTextureParameteri(tex, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    // @Note: The tiles are read straight from the sheet, the unpack state picks the sub rect.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
+    s32 layer = 0;
+    for (s32 i = 0; i < file_count; ++i) {
+        const IO_Image& image = images[i];
+        s32 x_count = image.width  / tile;
+        s32 y_count = image.height / tile;
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, image.width);
+
+        for (s32 itile = 0; itile < x_count * y_count; ++itile) {
+            s32 x_offset = itile / y_count;
+            s32 y_offset = itile % y_count;
+
+            // @Note: y_offset goes top to bottom, the image rows bottom to top.
+            glPixelStorei(GL_UNPACK_SKIP_PIXELS, x_offset * tile);
+            glPixelStorei(GL_UNPACK_SKIP_ROWS, image.height - (y_offset + 1) * tile);
+            glTextureSubImage3D(tex, 0, 0, 0, layer, tile, tile, 1, data_format, GL_UNSIGNED_BYTE, image.data);
+            ++layer;
+        }
+
+        if (image.is_owner) {
+            io_image_free(&images[i]);
+        }
+    }
+
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+    glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+    glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    delete[] images;
+}
+
+// @Note: levels[0] is the whole image, the rest its mips (cooked images bring them). With mips the minification
+// blends between levels, so zoomed out views stop aliasing. The block formats (see io_bc.h) go up as they are,
+// channels is only for the RGBA8 ones.
+static fn texture_upload(u32& tex, const IO_Image_Level* levels, s32 level_count, IO_Image_Format format, s32 channels, Texture_Filter filter_kind) -> void {
     glCreateTextures(GL_TEXTURE_2D, 1, &tex);
     
-    // Check if as RGB or RGBA.
-    s32 storage_format = image->channels == 4 ? GL_RGBA8 
-                       : image->channels == 3 ? GL_RGB8 : 0;
+    // Check the block format, or if as RGB or RGBA.
+    s32 storage_format = format == IO_Image_Format::BC1 ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+                       : format == IO_Image_Format::BC3 ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                       : format == IO_Image_Format::BC7 ? GL_COMPRESSED_RGBA_BPTC_UNORM
+                       : channels == 4 ? GL_RGBA8 
+                       : channels == 3 ? GL_RGB8 : 0;
 
     // Reserve the storage.    
-    glTextureStorage2D(tex, 1, storage_format, image->width, image->height);
+    glTextureStorage2D(tex, level_count, storage_format, levels[0].width, levels[0].height);
 
     // Texture config.
-    GLenum filter = def.filter == Texture_Filter::Nearest ? GL_NEAREST : 
-                    def.filter == Texture_Filter::Linear  ? GL_LINEAR  : 0;
+    GLenum filter = texture_filter(filter_kind);
+    GLenum min_filter = level_count == 1 ? filter 
+                      : filter_kind == Texture_Filter::Linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
 
-    glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, filter);
+    glTextureParameteri(tex, GL_TEXTURE_MIN_FILTER, min_filter);
     glTextureParameteri(tex, GL_TEXTURE_MAG_FILTER, filter);
     glTextureParameteri(tex, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTextureParameteri(tex, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
+    if (format != IO_Image_Format::RGBA8) {
+        for (s32 i = 0; i < level_count; ++i) {
+            glCompressedTextureSubImage2D(tex, i, 0, 0, levels[i].width, levels[i].height, storage_format, (GLsizei) levels[i].size, levels[i].data);
+        }
+        return;
+    }
+
     // Check if as RGB or RGBA. (Again :S)
-    s32 data_format = image->channels == 4 ? GL_RGBA 
-                    : image->channels == 3 ? GL_RGB : 0;
+    s32 data_format = channels == 4 ? GL_RGBA 
+                    : channels == 3 ? GL_RGB : 0;
     
     // Send the texture data to the gpu.
-    glTextureSubImage2D(tex, 0, 0, 0, image->width, image->height, data_format, GL_UNSIGNED_BYTE, image->data);
+    for (s32 i = 0; i < level_count; ++i) {
+        glTextureSubImage2D(tex, i, 0, 0, levels[i].width, levels[i].height, data_format, GL_UNSIGNED_BYTE, levels[i].data);
+    }
+}
+
+static fn texture_init_levels(Texture* texture, const Texture_Def& def, const IO_Image_Level* levels, s32 level_count, IO_Image_Format format, s32 channels) -> void {
+    u32& tex = texture->tex;
+    texture->width = levels[0].width;
+    texture->height = levels[0].height;
+    texture->kind = def.kind;
 
-    if (io_image_valid(image_buff)) {
-        io_image_free(&image_buff);
+    if (is_recording()) {
+        s64 bytes = 0;
+        for (s32 i = 0; i < level_count; ++i) {
+            bytes += (s64) levels[i].size;
+        }
+        tex = recording_name();
+        record(Graphics_Cmd::Texture_Init, bytes);
+    } else {
+        texture_upload(tex, levels, level_count, format, channels, def.filter);
     }
 
     // Build the tile info
     switch(def.kind) {
         case Texture_Kind::Tileset: {
-            if (!ensuref(def.tile_size <= texture->width && def.tile_size <= texture->height, "Error! Invalid tile_size!")) {
-                break;
-            }
-            s32 x_count = texture->width  / def.tile_size;
-            s32 y_count = texture->height / def.tile_size;
-            s32 cell_count = x_count * y_count;
-
-            if (!ensuref(cell_count <= texture->cells.max, "Error! Cell count is %i. Max allowed is %i", cell_count, texture->cells.max)) {
-                break;
-            }
-
-            texture->cells.count = cell_count;
-
-            for (s32 i = 0; i < cell_count; ++i) {
-                s32 x_offset = i / y_count;                
-                s32 y_offset = i % y_count;
-                
-                auto &cell = texture->cells.data[i];
-                cell.width = def.tile_size;
-                cell.height = def.tile_size;
-                cell.x = def.tile_size * x_offset;
-                cell.y = def.tile_size * y_offset;
-            }
+            build_cells(&texture->cells, texture->width, texture->height, def.tile_size);
         }
         case Texture_Kind::Default:
         default: {
@@ -191,12 +1010,309 @@ fn texture_init(Texture* texture, Texture_Def def) -> void {
     }
 }
 
+static fn texture_init_image(Texture* texture, const Texture_Def& def, IO_Image* image) -> void {
+    checkf(io_image_valid(*image), "Error! This is not a valid Image!");
+    if (!def.premultiplied) {
+        premultiply_image(image);
+    }
+    IO_Image_Level level = { image->data, image->width, image->height, (u64) image->width * image->height * image->channels };
+    texture_init_levels(texture, def, &level, 1, IO_Image_Format::RGBA8, image->channels);
+}
+
+// @Note: Straight from the mapping, every level.
+static fn texture_init_cooked(Texture* texture, const Texture_Def& def, IO_Cooked_Image* cooked) -> void {
+    texture_init_levels(texture, def, cooked->levels, cooked->level_count, cooked->format, 4);
+    io_image_unmap_cooked(cooked);
+}
+
+fn texture_init(Texture* texture, Texture_Def def) -> void {
+
+    if (def.kind == Texture_Kind::Array) {
+        texture_init_array(texture, def);
+        return;
+    }
+    
+    IO_Image image;
+    if (def.image) {
+        image = *def.image;
+        image.is_owner = false;
+    } else {
+        IO_Cooked_Image cooked;
+        if (io_image_map_cooked(def.filename, &cooked)) {
+            texture_init_cooked(texture, def, &cooked);
+            return;
+        }
+        io_image_load(def.filename, &image);
+    }
+
+    texture_init_image(texture, def, &image);
+
+    if (image.is_owner) {
+        io_image_free(&image);
+    }
+}
+
+fn texture_init_async(Texture* texture, Texture_Def def) -> Texture_Async {
+    checkf(def.kind != Texture_Kind::Array && !def.image, "Error! Only single files stream, use texture_init!");
+    *texture = {};
+    Texture_Async async;
+
+    // @Note: A cooked file is only a mapping and the upload, no need to wait for it.
+    IO_Cooked_Image cooked;
+    if (io_image_map_cooked(def.filename, &cooked)) {
+        texture_init_cooked(texture, def, &cooked);
+        return async;
+    }
+
+    async.texture = texture;
+    async.def = def;
+    async.ticket = io_image_load_async(def.filename);
+    return async;
+}
+
+fn texture_poll(Texture_Async* async) -> bool {
+    if (!async->texture) {
+        return true;
+    }
+    IO_Image image;
+    IO_Image_Status status = io_image_poll(async->ticket, &image);
+    if (status == IO_Image_Status::Pending) {
+        return false;
+    }
+    if (status == IO_Image_Status::Ready) {
+        texture_init_image(async->texture, async->def, &image);
+        io_image_free(&image);
+    }
+    async->texture = nullptr;
+    return true;
+}
+
+fn texture_wait(Texture_Async* async) -> void {
+    if (!async->texture) {
+        return;
+    }
+    IO_Image image;
+    if (io_image_wait(async->ticket, &image)) {
+        texture_init_image(async->texture, async->def, &image);
+        io_image_free(&image);
+    }
+    async->texture = nullptr;
+}
+
 fn texture_done(Texture* texture) -> void {
-    glDeleteTextures(1, &texture->tex);
+    if (is_recording()) {
+        record(Graphics_Cmd::Texture_Done);
+    } else {
+        glDeleteTextures(1, &texture->tex);
+    }
+    state_forget_texture(texture->tex);
     *texture = {};
 }
 
 fn texture_use(Texture texture, u32 unit) -> void {
     checkf(texture.tex != 0, "Error! This is not a valid Texture!");
-    glBindTextureUnit(unit, texture.tex);
+    state_bind_texture_unit(unit, texture.tex);
+}
+
+// @Note: Copies the image into the page (both rgba rows bottom to top, as loaded) and repeats its edges into the padding.
+static fn atlas_blit(IO_Image* page, const IO_Image& image, s32 x, s32 y, s32 padding) -> void {
+    for (s32 row = -padding; row < image.height + padding; ++row) {
+        s32 src_row = std::clamp(row, 0, image.height - 1);
+        u8* dst = page->data + ((u64) (y + row) * page->width + x - padding) * 4;
+        for (s32 col = -padding; col < image.width + padding; ++col) {
+            s32 src_col = std::clamp(col, 0, image.width - 1);
+            const u8* src = image.data + ((u64) src_row * image.width + src_col) * image.channels;
+            switch (image.channels) {
+                case 4: {
+                    // @Note: The page is premultiplied, like every texture.
+                    u32 alpha = image.premultiplied ? 255u : src[3];
+                    dst[0] = (u8) ((src[0] * alpha + 127u) / 255u);
+                    dst[1] = (u8) ((src[1] * alpha + 127u) / 255u);
+                    dst[2] = (u8) ((src[2] * alpha + 127u) / 255u);
+                    dst[3] = src[3];
+                } break;
+                case 3: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255;    break;
+                case 1: dst[0] = src[0]; dst[1] = src[0]; dst[2] = src[0]; dst[3] = 255;    break;
+            }
+            dst += 4;
+        }
+    }
+}
+
+fn atlas_init(Atlas* atlas, Atlas_Def def) -> void {
+    checkf(def.images && def.image_count > 0, "Error! This atlas has no images!");
+
+    s32 count = def.image_count;
+    s32 page_size = def.page_size;
+
+    IO_Image* images = new IO_Image[count];
+    stbrp_rect* rects = new stbrp_rect[count];
+    // @Note: Where each image landed. The rects can't tell: every round packs all of them again (see below).
+    struct Placement {
+        s32 page = -1; // -1 while pending, -2 if it was left out.
+        s32 x = 0;     // Of the image in the page, past the padding.
+        s32 y = 0;
+    };
+    Placement* placements = new Placement[count];
+    s32 pending = 0;
+
+    // @Note: The files decode on the job pool while the ones before them are taken, a window ahead so a big atlas
+    // doesn't take every async slot.
+    constexpr s32 load_window = 256;
+    IO_Image_Ticket* tickets = new IO_Image_Ticket[count];
+    fn load_async = [&](s32 i) {
+        if (i < count && !def.images[i].image) {
+            tickets[i] = io_image_load_async(def.images[i].filename);
+        }
+    };
+    for (s32 i = 0; i < std::min(count, load_window); ++i) {
+        load_async(i);
+    }
+
+    for (s32 i = 0; i < count; ++i) {
+        load_async(i + load_window);
+        const Texture_Def& image_def = def.images[i];
+        checkf(image_def.kind != Texture_Kind::Array, "Error! Array textures don't go into an atlas!");
+        if (image_def.image) {
+            images[i] = *image_def.image;
+            images[i].is_owner = false;
+        } else {
+            io_image_wait(tickets[i], &images[i]);
+        }
+        checkf(io_image_valid(images[i]), "Error! This is not a valid Image!");
+
+        stbrp_rect& rect = rects[i];
+        rect = {};
+        rect.id = i;
+        rect.w = images[i].width  + def.padding * 2;
+        rect.h = images[i].height + def.padding * 2;
+
+        // @Note: Left out, it draws with the white texture.
+        if (!ensuref(rect.w <= page_size && rect.h <= page_size, "Error! Image %i doesn't fit in a %i page!", i, page_size)) {
+            placements[i].page = -2;
+            continue;
+        }
+        ++pending;
+    }
+    delete[] tickets;
+
+    // @Note: Every round packs what is left into a new page.
+    stbrp_node* nodes = new stbrp_node[page_size];
+
+    while (pending > 0 && atlas->page_count < atlas->max_pages) {
+        s32 ipage = atlas->page_count++;
+
+        // @Note: Empty rects always pack (at 0, 0), that keeps the ones already placed (or left out) out of this page.
+        for (s32 i = 0; i < count; ++i) {
+            if (placements[i].page != -1) {
+                rects[i].w = 0;
+                rects[i].h = 0;
+            }
+        }
+
+        stbrp_context ctx;
+        stbrp_init_target(&ctx, page_size, page_size, nodes, page_size);
+        stbrp_pack_rects(&ctx, rects, count);
+
+        IO_Image page;
+        page.width = page_size;
+        page.height = page_size;
+        page.channels = 4;
+        page.block = io_storage_alloc((u64) page_size * page_size * 4);
+        page.data = page.block.data;
+        page.is_owner = true;
+        memset(page.data, 0, page.block.size);
+
+        for (s32 i = 0; i < count; ++i) {
+            stbrp_rect& rect = rects[i];
+            if (!rect.was_packed || placements[i].page != -1) {
+                continue;
+            }
+            placements[i] = { ipage, rect.x + def.padding, rect.y + def.padding };
+            atlas_blit(&page, images[i], placements[i].x, placements[i].y, def.padding);
+            --pending;
+        }
+
+        Texture_Def page_def;
+        page_def.image = &page;
+        page_def.filter = def.filter;
+        page_def.premultiplied = true;
+        texture_init(&atlas->pages[ipage], page_def);
+        io_image_free(&page);
+    }
+
+    ensuref(pending == 0, "Error! The images need more than %i atlas pages!", atlas->max_pages);
+
+    // Build the views.
+    atlas->views = new Texture[count];
+    atlas->view_count = count;
+
+    for (s32 i = 0; i < count; ++i) {
+        const Placement& placement = placements[i];
+        if (placement.page < 0) {
+            continue;
+        }
+
+        const Texture& page = atlas->pages[placement.page];
+        const IO_Image& image = images[i];
+        Texture& view = atlas->views[i];
+        view.tex = page.tex;
+        view.width = page.width;
+        view.height = page.height;
+
+        if (def.images[i].kind == Texture_Kind::Tileset) {
+            build_cells(&view.cells, image.width, image.height, def.images[i].tile_size);
+        } else {
+            view.cells.count = 1;
+            view.cells.data[0] = { 0, 0, image.width, image.height };
+        }
+
+        // @Note: The cells go top to bottom, while the page rows (as the image ones) go bottom to top.
+        s32 x = placement.x;
+        s32 y = page.height - (placement.y + image.height);
+        for (s32 icell = 0; icell < view.cells.count; ++icell) {
+            view.cells.data[icell].x += x;
+            view.cells.data[icell].y += y;
+        }
+    }
+
+#ifdef GAME_DEBUG
+    // @Note: No two images share pixels of a page.
+    for (s32 i = 0; i < count; ++i) {
+        for (s32 j = i + 1; j < count; ++j) {
+            const Placement& a = placements[i];
+            const Placement& b = placements[j];
+            if (a.page < 0 || a.page != b.page) {
+                continue;
+            }
+            bool apart = a.x + images[i].width <= b.x || b.x + images[j].width <= a.x ||
+                         a.y + images[i].height <= b.y || b.y + images[j].height <= a.y;
+            checkf(apart, "Error! Atlas images %i and %i overlap in page %i!", i, j, a.page);
+        }
+    }
+#endif
+
+    for (s32 i = 0; i < count; ++i) {
+        if (images[i].is_owner) {
+            io_image_free(&images[i]);
+        }
+    }
+
+    delete[] nodes;
+    delete[] placements;
+    delete[] rects;
+    delete[] images;
+}
+
+fn atlas_done(Atlas* atlas) -> void {
+    for (s32 i = 0; i < atlas->page_count; ++i) {
+        texture_done(&atlas->pages[i]);
+    }
+    delete[] atlas->views;
+    *atlas = {};
+}
+
+fn atlas_get(const Atlas& atlas, s32 image) -> const Texture* {
+    checkf(image >= 0 && image < atlas.view_count, "Error! Image %i is not in this atlas!", image);
+    return &atlas.views[image];
 }
@@ -1,6 +1,75 @@
 #pragma once
 
+#include "io_image.h"
+
+// @Note: State changing gl calls (program, vertex array, texture units, global buffer, blend and uniforms).
+// Redundant ones are skipped by a state cache, they count as elided.
+struct Graphics_Stats {
+    s32 issued = 0;
+    s32 elided = 0;
+};
+
+fn graphics_stats() -> Graphics_Stats;
+fn graphics_reset_stats() -> void;
+// @Note: Call it after touching the gl state outside of this module, the cache can't see those changes.
+fn graphics_invalidate_state() -> void;
+
+#define FOR_GRAPHICS_CMDS(DO) \
+    DO(Clear)                   \
+    DO(Blend)                   \
+    DO(Use_Program)             \
+    DO(Bind_Vertex_Array)       \
+    DO(Bind_Texture)            \
+    DO(Bind_Uniform_Buffer)     \
+    DO(Vertex_Buffer_Init)      \
+    DO(Vertex_Buffer_Done)      \
+    DO(Vertex_Buffer_Update)    \
+    DO(Vertex_Buffer_Source)    \
+    DO(Draw)                    \
+    DO(Draw_Instanced)          \
+    DO(Shader_Init)             \
+    DO(Shader_Done)             \
+    DO(Shader_Set_Param)        \
+    DO(Global_Buffer_Init)      \
+    DO(Global_Buffer_Done)      \
+    DO(Global_Buffer_Update)    \
+    DO(Stream_Buffer_Init)      \
+    DO(Stream_Buffer_Done)      \
+    DO(Stream_Buffer_Commit)    \
+    DO(Stream_Buffer_Fence)     \
+    DO(Texture_Init)            \
+    DO(Texture_Done)            \
+
+enum class Graphics_Cmd : u8 {
+    #define DeclareEnumEntry(name) name,
+        FOR_GRAPHICS_CMDS(DeclareEnumEntry)
+    #undef DeclareEnumEntry
+    Count
+};
+
+fn to_string(Graphics_Cmd cmd) -> const char*;
+
+enum class Graphics_Backend : u8 {
+    GL,
+    Recording, // No gpu. Objects get fake names and the streams cpu memory, the commands are counted (and serialized).
+};
+
+struct Graphics_Recording {
+    s32 calls[(s32) Graphics_Cmd::Count] = {};
+    s64 bytes = 0;          // Sent to the "gpu": buffer and texture data, stream commits and uniforms.
+    bool serialize = false; // Fill commands with one block per command.
+    Serializer commands;
+};
+
+// @Note: Pick the backend before creating any graphics object, they don't move between backends.
+// The state cache keeps working under the recording backend, so the counts only include the issued state changes.
+fn graphics_set_backend(Graphics_Backend backend, bool serialize = false) -> void;
+fn graphics_backend() -> Graphics_Backend;
+fn graphics_recording() -> const Graphics_Recording&;
+fn graphics_reset_recording() -> void;
+
 fn clear_back_buffer(Vec4 color = Color.Corn_Flower_Blue) -> void;
+// @Note: Premultiplied alpha blending (GL_ONE, GL_ONE_MINUS_SRC_ALPHA), every texture_init converts to it.
 fn ser_blend_enabled(bool enabled = true) -> void;
 
 struct Vert_View {
@@ -19,10 +88,16 @@ struct Attr_View {
     s32 count = 0;
 };
 
+// @Note: A vertex (or instance) view with size 0 creates no buffer of its own, the data comes
+// from a Stream_Buffer attached with vertex_buffer_set_source (the stride is taken from the attributes).
 struct Vertex_Buffer_Def {
     Vert_View verts;
     Elem_View elems;
     Attr_View attrs;
+    // @Note: Optional. Data that advances once per instance instead of once per vertex.
+    // Its attributes take the locations right after the vertex ones.
+    Vert_View insts;
+    Attr_View inst_attrs;
 };
 
 struct Vertex_Buffer {
@@ -30,23 +105,65 @@ struct Vertex_Buffer {
     u32 ebo = 0u;
     u32 vbo = 0u;
     s32 elem_count = 0u;
+    u32 inst_vbo = 0u;
+    s32 stride = 0;
+    s32 inst_stride = 0;
 };
 
 fn vertex_buffer_init(Vertex_Buffer* obj, Vertex_Buffer_Def def) -> void;
 fn vertex_buffer_done(Vertex_Buffer* obj) -> void;
 fn vertex_buffer_draw(Vertex_Buffer obj) -> void;
+// @Note: Draws just the first elem_count elements. Useful for dynamic buffers that are partially filled.
+fn vertex_buffer_draw(Vertex_Buffer obj, s32 elem_count) -> void;
+// @Note: Overwrites the first size bytes of the vertex data. The buffer must have been created without data (dynamic).
+fn vertex_buffer_update(Vertex_Buffer obj, const void* data, s32 size) -> void;
+fn vertex_buffer_update_instances(Vertex_Buffer obj, const void* data, s32 size) -> void;
+fn vertex_buffer_draw_instanced(Vertex_Buffer obj, s32 inst_count) -> void;
 
 struct Shader_Def {
     std::string_view filename;
+    std::string_view defines; // @Note: Ex: "#define INSTANCED \n".
+    // @Note: Linked programs are kept here as driver binaries, so the next launches skip the compile.
+    // Keyed by a hash of the source, the defines and the driver. Empty disables the cache.
+    std::string_view cache_dir = ".shader_cache";
+};
+
+// @Note: Active uniform or uniform block, found when the program is linked.
+struct Shader_Param {
+    enum Kind : u8 { Uniform, Block };
+    u64 hash = 0;       // hash_str of the name. Arrays drop the "[0]".
+    Kind kind = Uniform;
+    Data_Type type = Data_Type::None;
+    s32 location = -1;  // Uniform location or block index.
+    s32 count = 0;      // Array elements (uniforms) or data size in bytes (blocks).
+    s32 binding = 0;    // Blocks only.
+    s32 value = -1;     // Offset of the last uploaded value in Shader_Params::values (uniforms only).
+};
+
+// @Note: Open addressing table keyed by the name hash.
+struct Shader_Params {
+    Shader_Param* table = nullptr;
+    u32 cap = 0u; // Power of two.
+    u8* values = nullptr;
+    bool* uploaded = nullptr; // Per param, if there is a value in values yet.
 };
 
 struct Shader {
     u32 pgm = 0u;
+    Shader_Params* params = nullptr;
 };
 
 fn shader_init(Shader* shader, Shader_Def def) -> void;
 fn shader_done(Shader* shader) -> void;
 fn shader_use(Shader shader) -> void;
+// @Note: Ex: shader_param(shader, hash_str("u_samplers")). Returns nullptr if the shader doesn't have it.
+// The pointer is the cached handle for the setters below, it lives as long as the shader.
+fn shader_param(Shader shader, u64 hash) -> const Shader_Param*;
+// @Note: The setters skip the upload if the value is the same as the last one.
+// Works for int, bool and sampler uniforms.
+fn shader_set_param(Shader shader, const Shader_Param* param, const s32* data, s32 count) -> void;
+// @Note: Works for float, vec and mat uniforms. count is in elements of the uniform type (ex: 1 for one mat4).
+fn shader_set_param(Shader shader, const Shader_Param* param, const f32* data, s32 count) -> void;
 fn shader_set_param(Shader shader, std::string_view name, const s32* data, s32 count) -> void;
 
 struct Global_Buffer_Def {
@@ -64,6 +181,59 @@ fn global_buffer_use(Global_Buffer obj) -> void;
 
 fn global_buffer_update(Global_Buffer obj, const void* data) -> void;
 
+// @Note: Persistent mapped ring buffer for data we rewrite every frame (vertices, instances, uniforms).
+// The buffer is split in regions, we fill one region and when it runs out of space we fence it and move
+// to the next one. We only wait for the gpu if the next region is still in use (that's a stall).
+// There are no driver copies: we write straight into the memory the gpu reads from.
+// Rule: submit the draws that read a committed range before mapping again, the next map may fence the region.
+
+struct Stream_Buffer_Def {
+    s32 size = 0;    // Bytes per region. Any single allocation must fit in it.
+    s32 regions = 3;
+};
+
+struct Stream_Alloc {
+    void* data = nullptr; // Cpu write pointer. Write only, this memory is slow to read.
+    s32 offset = 0;       // Gpu offset inside the stream buffer.
+    s32 size = 0;
+};
+
+struct Stream_Buffer_Stats {
+    s32 allocs = 0;
+    s64 bytes = 0;
+    s32 region_switches = 0;
+    s32 stalls = 0;         // Times we had to wait for the gpu to release a region. If this isn't 0, make the regions bigger.
+    f64 stall_seconds = 0.0;
+};
+
+struct Stream_Buffer {
+    static constexpr s32 max_regions = 4;
+    u32 buf = 0u;
+    u8* mapped = nullptr;
+    s32 region_size = 0;
+    s32 region_count = 0;
+    s32 region = 0; // Current region.
+    s32 head = 0;   // Bytes used in the current region.
+    s32 uniform_align = 0;
+    void* fences[max_regions] = {};
+    Stream_Buffer_Stats stats;
+};
+
+fn stream_buffer_init(Stream_Buffer* obj, Stream_Buffer_Def def) -> void;
+fn stream_buffer_done(Stream_Buffer* obj) -> void;
+// @Note: Returns room for size bytes but doesn't consume it. Call stream_buffer_commit with what you actually wrote.
+fn stream_buffer_map(Stream_Buffer* obj, s32 size, s32 align = 16) -> Stream_Alloc;
+fn stream_buffer_commit(Stream_Buffer* obj, Stream_Alloc alloc, s32 used) -> void;
+// @Note: map + commit of the whole size.
+fn stream_buffer_alloc(Stream_Buffer* obj, s32 size, s32 align = 16) -> Stream_Alloc;
+fn stream_buffer_reset_stats(Stream_Buffer* obj) -> void;
+
+// @Note: Binds a committed range of the stream as the global (uniform) buffer. Allocate it with obj.uniform_align.
+fn global_buffer_use(const Stream_Buffer& obj, Stream_Alloc range) -> void;
+// @Note: Makes the vertex (or instance) data of obj come from the stream, starting at offset.
+fn vertex_buffer_set_source(Vertex_Buffer obj, const Stream_Buffer& stream, s32 offset) -> void;
+fn vertex_buffer_set_instance_source(Vertex_Buffer obj, const Stream_Buffer& stream, s32 offset) -> void;
+
 enum class Texture_Filter {
     Nearest, // Convierte u, v a coordenadas de texel, devuelve el texel más cercano.
     Linear, // Localiza los cuatro texels vecinos alrededor de las u, v e interpola los colores basándose en la distancia al centro.
@@ -75,7 +245,8 @@ enum class Texture_Filter {
 
 enum class Texture_Kind {
     Default,
-    Tileset
+    Tileset,
+    Array, // GL_TEXTURE_2D_ARRAY, every tile is a layer (no cell cap). Sprites pick the layer instead of a cell.
 };
 
 struct Texture_Def {
@@ -84,6 +255,12 @@ struct Texture_Def {
     Texture_Filter filter = Texture_Filter::Nearest; 
     Texture_Kind kind = Texture_Kind::Default;
     s32 tile_size = 0;  
+    // @Note: Texture_Kind::Array can stack several sheets with the same tile_size (a whole unit animation set
+    // under one bind). Their layers go one after the other, in the order of the files.
+    const std::string_view* filenames = nullptr;
+    s32 filename_count = 0;
+    // @Note: Textures are premultiplied (see ser_blend_enabled), set it if image already is (or there's no alpha).
+    bool premultiplied = false;
 };
 
 struct Subtex {
@@ -101,11 +278,53 @@ struct Subtex_Array {
 
 struct Texture {
     u32 tex = 0u;
-    s32 width = 0;
+    s32 width = 0;  // Of a layer, for Texture_Kind::Array.
     s32 height = 0;
+    s32 layers = 0; // Only Texture_Kind::Array.
+    Texture_Kind kind = Texture_Kind::Default;
     Subtex_Array cells;
 };
 
 fn texture_init(Texture* texture, Texture_Def def) -> void;
 fn texture_done(Texture* texture) -> void;
+
+// @Note: Streaming texture_init, for a single file (not Texture_Kind::Array): it decodes on the job pool and
+// texture_poll creates the gl texture on the main thread once it's there. Until then texture->tex is 0, so skip
+// drawing it. The filename must outlive the load.
+struct Texture_Async {
+    Texture* texture = nullptr;
+    Texture_Def def;
+    IO_Image_Ticket ticket;
+};
+
+fn texture_init_async(Texture* texture, Texture_Def def) -> Texture_Async;
+// @Note: True once it's done (texture->tex stays 0 if the file failed). Cheap while pending, call it every frame.
+fn texture_poll(Texture_Async* async) -> bool;
+// @Note: Blocks till it's done, for the shutdowns and the loading screens.
+fn texture_wait(Texture_Async* async) -> void;
 fn texture_use(Texture texture, u32 unit = 0) -> void;
+
+// @Note: Packs many images into a few big pages at load time, so the sprites stop breaking batches on texture changes.
+// Each image is described like a single texture (filename or image, kind and tile_size). The filter goes for every page.
+struct Atlas_Def {
+    const Texture_Def* images = nullptr;
+    s32 image_count = 0;
+    s32 page_size = 2048;
+    s32 padding = 1; // Edge pixels are repeated into it, so linear filtering doesn't bleed the neighbours.
+    Texture_Filter filter = Texture_Filter::Nearest;
+};
+
+// @Note: Every image gets a Texture view of the page where it landed: same gl texture and page size, and its
+// cells (or a single one with the whole image) placed in the page. So they draw as any other tileset.
+// The views belong to the atlas, don't call texture_done on them.
+struct Atlas {
+    static constexpr s32 max_pages = 8;
+    Texture pages[max_pages];
+    s32 page_count = 0;
+    Texture* views = nullptr;
+    s32 view_count = 0;
+};
+
+fn atlas_init(Atlas* atlas, Atlas_Def def) -> void;
+fn atlas_done(Atlas* atlas) -> void;
+fn atlas_get(const Atlas& atlas, s32 image) -> const Texture*;
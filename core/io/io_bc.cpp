@@ -0,0 +1,621 @@
+#include "io_bc.h"
+#include "base_jobs.h"
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#   define BC_X86 1
+#   include <emmintrin.h>
+#else
+#   define BC_X86 0
+#endif
+
+// @Note: The 16 pixels of a block by channel (r, g, b, a), so the fit takes 4 pixels per SSE register.
+struct Bc_Pixels {
+    alignas(16) f32 c[4][16];
+};
+
+// @Note: The colors a block can pick from, made from the quantized endpoints the same way the decoder does.
+struct Bc_Palette {
+    f32 colors[16][4];
+    s32 count = 0;
+};
+
+static constexpr f32 bc_max_error = 1e30f;
+
+static fn load_pixels(const u8* rgba, s32 width, s32 height, s32 block_x, s32 block_y, Bc_Pixels* pixels) -> void {
+    for (s32 y = 0; y < 4; ++y) {
+        s32 row = std::min(block_y * 4 + y, height - 1);
+        for (s32 x = 0; x < 4; ++x) {
+            s32 column = std::min(block_x * 4 + x, width - 1);
+            const u8* pixel = rgba + ((u64) row * width + column) * 4;
+            for (s32 c = 0; c < 4; ++c) {
+                pixels->c[c][y * 4 + x] = pixel[c];
+            }
+        }
+    }
+}
+
+static fn store_pixels(const u8 colors[16][4], s32 width, s32 height, s32 block_x, s32 block_y, u8* rgba) -> void {
+    for (s32 y = 0; y < 4 && block_y * 4 + y < height; ++y) {
+        for (s32 x = 0; x < 4 && block_x * 4 + x < width; ++x) {
+            u8* pixel = rgba + ((u64) (block_y * 4 + y) * width + block_x * 4 + x) * 4;
+            memcpy(pixel, colors[y * 4 + x], 4);
+        }
+    }
+}
+
+static fn clamp_unorm(f32 value) -> f32 {
+    return std::min(std::max(value, 0.0f), 255.0f);
+}
+
+// @Note: For every pixel in mask, the closest palette color over the channels [first, first + count). Returns the
+// summed squared error, the pixels out of the mask get index 0 and count nothing. It's where the encoders spend
+// their time (BC7 tries 16 colors of 4 channels per pixel), SSE goes 4 pixels at once.
+static fn fit_indices(const Bc_Pixels& pixels, s32 first, s32 count, u16 mask, const Bc_Palette& palette, u8 indices[16]) -> f32 {
+    f32 error = 0.0f;
+#if BC_X86
+    for (s32 i = 0; i < 16; i += 4) {
+        __m128 best = _mm_set1_ps(bc_max_error);
+        __m128 best_index = _mm_setzero_ps();
+        for (s32 p = 0; p < palette.count; ++p) {
+            __m128 distance = _mm_setzero_ps();
+            for (s32 c = first; c < first + count; ++c) {
+                __m128 d = _mm_sub_ps(_mm_load_ps(pixels.c[c] + i), _mm_set1_ps(palette.colors[p][c]));
+                distance = _mm_add_ps(distance, _mm_mul_ps(d, d));
+            }
+            __m128 closer = _mm_cmplt_ps(distance, best);
+            best = _mm_min_ps(distance, best);
+            best_index = _mm_or_ps(_mm_and_ps(closer, _mm_set1_ps((f32) p)), _mm_andnot_ps(closer, best_index));
+        }
+
+        alignas(16) f32 lane_indices[4];
+        alignas(16) f32 lane_errors[4];
+        _mm_store_ps(lane_indices, best_index);
+        _mm_store_ps(lane_errors, best);
+        for (s32 lane = 0; lane < 4; ++lane) {
+            bool used = mask & (1u << (i + lane));
+            indices[i + lane] = used ? (u8) lane_indices[lane] : 0;
+            error += used ? lane_errors[lane] : 0.0f;
+        }
+    }
+#else
+    for (s32 i = 0; i < 16; ++i) {
+        indices[i] = 0;
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        f32 best = bc_max_error;
+        for (s32 p = 0; p < palette.count; ++p) {
+            f32 distance = 0.0f;
+            for (s32 c = first; c < first + count; ++c) {
+                f32 d = pixels.c[c][i] - palette.colors[p][c];
+                distance += d * d;
+            }
+            if (distance < best) {
+                best = distance;
+                indices[i] = (u8) p;
+            }
+        }
+        error += best;
+    }
+#endif
+    return error;
+}
+
+// @Note: The endpoints to start from: the line the colors in mask spread along (the covariance's main axis, by
+// power iteration), cut where the first and the last pixel project on it.
+static fn fit_line(const Bc_Pixels& pixels, s32 count, u16 mask, f32 e0[4], f32 e1[4]) -> void {
+    f32 mean[4] = {};
+    f32 low[4] = { 255.0f, 255.0f, 255.0f, 255.0f };
+    f32 high[4] = {};
+    s32 used = 0;
+    for (s32 i = 0; i < 16; ++i) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        for (s32 c = 0; c < count; ++c) {
+            mean[c] += pixels.c[c][i];
+            low[c] = std::min(low[c], pixels.c[c][i]);
+            high[c] = std::max(high[c], pixels.c[c][i]);
+        }
+        ++used;
+    }
+    for (s32 c = 0; c < count; ++c) {
+        mean[c] /= (f32) used;
+    }
+
+    f32 covariance[4][4] = {};
+    for (s32 i = 0; i < 16; ++i) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        for (s32 a = 0; a < count; ++a) {
+            for (s32 b = 0; b < count; ++b) {
+                covariance[a][b] += (pixels.c[a][i] - mean[a]) * (pixels.c[b][i] - mean[b]);
+            }
+        }
+    }
+
+    // The bounding box diagonal is a good first guess, a few iterations are enough from there.
+    f32 axis[4] = {};
+    for (s32 c = 0; c < count; ++c) {
+        axis[c] = high[c] - low[c];
+    }
+    for (s32 iteration = 0; iteration < 8; ++iteration) {
+        f32 next[4] = {};
+        f32 length = 0.0f;
+        for (s32 a = 0; a < count; ++a) {
+            for (s32 b = 0; b < count; ++b) {
+                next[a] += covariance[a][b] * axis[b];
+            }
+            length += next[a] * next[a];
+        }
+        if (length < 1e-12f) {
+            break;
+        }
+        length = 1.0f / sqrtf(length);
+        for (s32 c = 0; c < count; ++c) {
+            axis[c] = next[c] * length;
+        }
+    }
+
+    f32 t_min = bc_max_error;
+    f32 t_max = -bc_max_error;
+    for (s32 i = 0; i < 16; ++i) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        f32 t = 0.0f;
+        for (s32 c = 0; c < count; ++c) {
+            t += (pixels.c[c][i] - mean[c]) * axis[c];
+        }
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+    for (s32 c = 0; c < count; ++c) {
+        e0[c] = clamp_unorm(mean[c] + axis[c] * t_min);
+        e1[c] = clamp_unorm(mean[c] + axis[c] * t_max);
+    }
+}
+
+// @Note: Least squares endpoints for the indices already picked: pixel = e0 * (1 - w) + e1 * w, w by index.
+// False if the indices don't pin both ends down (all on one weight).
+static fn refine_endpoints(const Bc_Pixels& pixels, s32 count, u16 mask, const u8 indices[16], const f32* weights, f32 e0[4], f32 e1[4]) -> bool {
+    f32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    f32 ap[4] = {};
+    f32 bp[4] = {};
+    for (s32 i = 0; i < 16; ++i) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        f32 b = weights[indices[i]];
+        f32 a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (s32 c = 0; c < count; ++c) {
+            ap[c] += a * pixels.c[c][i];
+            bp[c] += b * pixels.c[c][i];
+        }
+    }
+
+    f32 det = aa * bb - ab * ab;
+    if (fabsf(det) < 1e-6f) {
+        return false;
+    }
+    f32 inv_det = 1.0f / det;
+    for (s32 c = 0; c < count; ++c) {
+        e0[c] = clamp_unorm((ap[c] * bb - bp[c] * ab) * inv_det);
+        e1[c] = clamp_unorm((bp[c] * aa - ap[c] * ab) * inv_det);
+    }
+    return true;
+}
+
+// @Note: Little endian, bit 0 first, the way BC7 lays its fields.
+static fn put_bits(u8* block, u32* pos, u32 value, u32 count) -> void {
+    for (u32 i = 0; i < count; ++i, ++*pos) {
+        block[*pos >> 3] |= (u8) (((value >> i) & 1u) << (*pos & 7u));
+    }
+}
+
+static fn get_bits(const u8* block, u32* pos, u32 count) -> u32 {
+    u32 value = 0;
+    for (u32 i = 0; i < count; ++i, ++*pos) {
+        value |= (u32) ((block[*pos >> 3] >> (*pos & 7u)) & 1u) << i;
+    }
+    return value;
+}
+
+// =========================================
+// @Region: BC1 (and the color half of BC3).
+
+static fn pack_565(const f32 color[4]) -> u16 {
+    u32 r = (u32) (color[0] * (31.0f / 255.0f) + 0.5f);
+    u32 g = (u32) (color[1] * (63.0f / 255.0f) + 0.5f);
+    u32 b = (u32) (color[2] * (31.0f / 255.0f) + 0.5f);
+    return (u16) ((r << 11) | (g << 5) | b);
+}
+
+// @Note: The 4 colors of a color block. With c0 <= c1 BC1 has 3 colors and transparent black, BC3 always 4.
+static fn bc1_colors(u16 c0, u16 c1, bool four_colors, u8 colors[4][4]) -> void {
+    u16 ends[2] = { c0, c1 };
+    for (s32 e = 0; e < 2; ++e) {
+        u32 r = (ends[e] >> 11) & 31u;
+        u32 g = (ends[e] >> 5) & 63u;
+        u32 b = ends[e] & 31u;
+        colors[e][0] = (u8) ((r << 3) | (r >> 2));
+        colors[e][1] = (u8) ((g << 2) | (g >> 4));
+        colors[e][2] = (u8) ((b << 3) | (b >> 2));
+        colors[e][3] = 255;
+    }
+    for (s32 c = 0; c < 3; ++c) {
+        u32 a = colors[0][c];
+        u32 b = colors[1][c];
+        if (four_colors || c0 > c1) {
+            colors[2][c] = (u8) ((2u * a + b) / 3u);
+            colors[3][c] = (u8) ((a + 2u * b) / 3u);
+        } else {
+            colors[2][c] = (u8) ((a + b) / 2u);
+            colors[3][c] = 0;
+        }
+    }
+    colors[2][3] = 255;
+    colors[3][3] = four_colors || c0 > c1 ? 255 : 0;
+}
+
+// @Note: punch_through is BC1 on its own: the pixels with alpha < 128 take index 3 of the 3 color mode
+// (transparent black). In BC3 the color block always has 4 colors and the alpha block does the rest.
+static fn bc1_encode_color(const Bc_Pixels& pixels, bool punch_through, u8* out) -> void {
+    u16 opaque = 0xFFFFu;
+    if (punch_through) {
+        opaque = 0;
+        for (s32 i = 0; i < 16; ++i) {
+            opaque |= pixels.c[3][i] >= 128.0f ? (u16) (1u << i) : (u16) 0;
+        }
+    }
+
+    u16 best_c0 = 0;
+    u16 best_c1 = 0;
+    u8 best_indices[16] = {};
+    if (opaque != 0) {
+        static constexpr f32 weights_4[] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+        static constexpr f32 weights_3[] = { 0.0f, 1.0f, 0.5f };
+        bool three_colors = opaque != 0xFFFFu;
+
+        f32 e0[4], e1[4];
+        fit_line(pixels, 3, opaque, e0, e1);
+
+        f32 best_error = bc_max_error;
+        for (s32 iteration = 0; iteration < 3; ++iteration) {
+            u16 c0 = pack_565(e0);
+            u16 c1 = pack_565(e1);
+            if (three_colors ? c0 > c1 : c0 < c1) {
+                std::swap(c0, c1);
+                std::swap(e0, e1);
+            }
+
+            // @Note: Same endpoints decode in the 3 color mode, so index 3 is off limits there.
+            bool three = three_colors || c0 == c1;
+            u8 colors[4][4];
+            bc1_colors(c0, c1, !punch_through, colors);
+            Bc_Palette palette;
+            palette.count = three ? 3 : 4;
+            for (s32 p = 0; p < palette.count; ++p) {
+                for (s32 c = 0; c < 3; ++c) {
+                    palette.colors[p][c] = colors[p][c];
+                }
+            }
+
+            u8 indices[16];
+            f32 error = fit_indices(pixels, 0, 3, opaque, palette, indices);
+            if (error < best_error) {
+                best_error = error;
+                best_c0 = c0;
+                best_c1 = c1;
+                memcpy(best_indices, indices, sizeof(indices));
+            }
+            if (error == 0.0f || !refine_endpoints(pixels, 3, opaque, indices, three ? weights_3 : weights_4, e0, e1)) {
+                break;
+            }
+        }
+    }
+
+    u32 bits = 0;
+    for (s32 i = 0; i < 16; ++i) {
+        u32 index = opaque & (1u << i) ? best_indices[i] : 3u;
+        bits |= index << (i * 2);
+    }
+    memcpy(out, &best_c0, 2);
+    memcpy(out + 2, &best_c1, 2);
+    memcpy(out + 4, &bits, 4);
+}
+
+static fn bc1_decode_color(const u8* block, bool four_colors, u8 out[16][4]) -> void {
+    u16 c0, c1;
+    u32 bits;
+    memcpy(&c0, block, 2);
+    memcpy(&c1, block + 2, 2);
+    memcpy(&bits, block + 4, 4);
+    u8 colors[4][4];
+    bc1_colors(c0, c1, four_colors, colors);
+    for (s32 i = 0; i < 16; ++i) {
+        u8 alpha = out[i][3];
+        memcpy(out[i], colors[(bits >> (i * 2)) & 3u], 4);
+        if (four_colors) {
+            out[i][3] = alpha;
+        }
+    }
+}
+
+// =========================================
+// @Region: BC3 alpha.
+
+// @Note: a0 > a1: 8 steps between them. Otherwise 6 steps plus 0 and 255.
+static fn bc3_alphas(u8 a0, u8 a1, u8 alphas[8]) -> void {
+    alphas[0] = a0;
+    alphas[1] = a1;
+    if (a0 > a1) {
+        for (u32 i = 1; i < 7; ++i) {
+            alphas[i + 1] = (u8) (((7u - i) * a0 + i * a1 + 3u) / 7u);
+        }
+    } else {
+        for (u32 i = 1; i < 5; ++i) {
+            alphas[i + 1] = (u8) (((5u - i) * a0 + i * a1 + 2u) / 5u);
+        }
+        alphas[6] = 0;
+        alphas[7] = 255;
+    }
+}
+
+static fn bc3_fit_alpha(const Bc_Pixels& pixels, u8 a0, u8 a1, u8 indices[16]) -> f32 {
+    u8 alphas[8];
+    bc3_alphas(a0, a1, alphas);
+    Bc_Palette palette;
+    palette.count = 8;
+    for (s32 p = 0; p < 8; ++p) {
+        palette.colors[p][3] = alphas[p];
+    }
+    return fit_indices(pixels, 3, 1, 0xFFFFu, palette, indices);
+}
+
+// @Note: Tries both modes: the 8 steps over the whole range, and the 6 steps over what's between 0 and 255 (better
+// when a soft edge shares the block with fully transparent or opaque pixels).
+static fn bc3_encode_alpha(const Bc_Pixels& pixels, u8* out) -> void {
+    u8 low = 255, high = 0;
+    u8 inner_low = 255, inner_high = 0;
+    for (s32 i = 0; i < 16; ++i) {
+        u8 alpha = (u8) pixels.c[3][i];
+        low = std::min(low, alpha);
+        high = std::max(high, alpha);
+        if (alpha != 0 && alpha != 255) {
+            inner_low = std::min(inner_low, alpha);
+            inner_high = std::max(inner_high, alpha);
+        }
+    }
+
+    u8 a0 = high;
+    u8 a1 = low;
+    u8 indices[16] = {};
+    if (high != low) {
+        f32 error = bc3_fit_alpha(pixels, a0, a1, indices);
+        if (error > 0.0f && inner_low <= inner_high) {
+            u8 inner_indices[16];
+            if (bc3_fit_alpha(pixels, inner_low, inner_high, inner_indices) < error) {
+                a0 = inner_low;
+                a1 = inner_high;
+                memcpy(indices, inner_indices, sizeof(indices));
+            }
+        }
+    }
+
+    memset(out, 0, 8);
+    out[0] = a0;
+    out[1] = a1;
+    u32 pos = 16;
+    for (s32 i = 0; i < 16; ++i) {
+        put_bits(out, &pos, indices[i], 3);
+    }
+}
+
+static fn bc3_decode_alpha(const u8* block, u8 out[16][4]) -> void {
+    u8 alphas[8];
+    bc3_alphas(block[0], block[1], alphas);
+    u32 pos = 16;
+    for (s32 i = 0; i < 16; ++i) {
+        out[i][3] = alphas[get_bits(block, &pos, 3)];
+    }
+}
+
+// =========================================
+// @Region: BC7 (mode 6).
+
+static constexpr u32 g_bc7_weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// @Note: 7 bits per channel, the p bit is the 8th (lowest) bit of the 4 channels.
+struct Bc7_Endpoint {
+    u8 q[4];
+    u8 p;
+};
+
+// @Note: The p bit is shared by the channels, takes the one that lands closer.
+static fn bc7_quantize(const f32 color[4]) -> Bc7_Endpoint {
+    Bc7_Endpoint best = {};
+    f32 best_error = bc_max_error;
+    for (u8 p = 0; p < 2; ++p) {
+        Bc7_Endpoint it = {};
+        it.p = p;
+        f32 error = 0.0f;
+        for (s32 c = 0; c < 4; ++c) {
+            it.q[c] = (u8) std::min(std::max((s32) ((color[c] - p) * 0.5f + 0.5f), 0), 127);
+            f32 d = (f32) ((it.q[c] << 1) | p) - color[c];
+            error += d * d;
+        }
+        if (error < best_error) {
+            best_error = error;
+            best = it;
+        }
+    }
+    return best;
+}
+
+static fn bc7_colors(const Bc7_Endpoint& e0, const Bc7_Endpoint& e1, u8 colors[16][4]) -> void {
+    for (s32 c = 0; c < 4; ++c) {
+        u32 a = (u32) ((e0.q[c] << 1) | e0.p);
+        u32 b = (u32) ((e1.q[c] << 1) | e1.p);
+        for (s32 i = 0; i < 16; ++i) {
+            colors[i][c] = (u8) (((64u - g_bc7_weights[i]) * a + g_bc7_weights[i] * b + 32u) >> 6);
+        }
+    }
+}
+
+static fn bc7_encode(const Bc_Pixels& pixels, u8* out) -> void {
+    static constexpr f32 weights[16] = {
+        0.0f / 64, 4.0f / 64, 9.0f / 64, 13.0f / 64, 17.0f / 64, 21.0f / 64, 26.0f / 64, 30.0f / 64,
+        34.0f / 64, 38.0f / 64, 43.0f / 64, 47.0f / 64, 51.0f / 64, 55.0f / 64, 60.0f / 64, 64.0f / 64,
+    };
+
+    f32 e0[4], e1[4];
+    fit_line(pixels, 4, 0xFFFFu, e0, e1);
+
+    Bc7_Endpoint best_e0 = {}, best_e1 = {};
+    u8 best_indices[16] = {};
+    f32 best_error = bc_max_error;
+    for (s32 iteration = 0; iteration < 3; ++iteration) {
+        Bc7_Endpoint q0 = bc7_quantize(e0);
+        Bc7_Endpoint q1 = bc7_quantize(e1);
+        u8 colors[16][4];
+        bc7_colors(q0, q1, colors);
+        Bc_Palette palette;
+        palette.count = 16;
+        for (s32 p = 0; p < 16; ++p) {
+            for (s32 c = 0; c < 4; ++c) {
+                palette.colors[p][c] = colors[p][c];
+            }
+        }
+
+        u8 indices[16];
+        f32 error = fit_indices(pixels, 0, 4, 0xFFFFu, palette, indices);
+        if (error < best_error) {
+            best_error = error;
+            best_e0 = q0;
+            best_e1 = q1;
+            memcpy(best_indices, indices, sizeof(indices));
+        }
+        if (error == 0.0f || !refine_endpoints(pixels, 4, 0xFFFFu, indices, weights, e0, e1)) {
+            break;
+        }
+    }
+
+    // @Note: The first index is stored with 3 bits (its top bit is implied 0), swapping the ends flips it.
+    if (best_indices[0] >= 8) {
+        std::swap(best_e0, best_e1);
+        for (u8& index : best_indices) {
+            index = (u8) (15u - index);
+        }
+    }
+
+    memset(out, 0, 16);
+    u32 pos = 0;
+    put_bits(out, &pos, 1u << 6, 7);
+    for (s32 c = 0; c < 4; ++c) {
+        put_bits(out, &pos, best_e0.q[c], 7);
+        put_bits(out, &pos, best_e1.q[c], 7);
+    }
+    put_bits(out, &pos, best_e0.p, 1);
+    put_bits(out, &pos, best_e1.p, 1);
+    for (s32 i = 0; i < 16; ++i) {
+        put_bits(out, &pos, best_indices[i], i == 0 ? 3 : 4);
+    }
+}
+
+// @Note: Only mode 6 (what bc7_encode writes), the other modes come out transparent black.
+static fn bc7_decode(const u8* block, u8 out[16][4]) -> void {
+    if ((block[0] & 0x7Fu) != 0x40u) {
+        memset(out, 0, 16 * 4);
+        return;
+    }
+
+    Bc7_Endpoint e0 = {}, e1 = {};
+    u32 pos = 7;
+    for (s32 c = 0; c < 4; ++c) {
+        e0.q[c] = (u8) get_bits(block, &pos, 7);
+        e1.q[c] = (u8) get_bits(block, &pos, 7);
+    }
+    e0.p = (u8) get_bits(block, &pos, 1);
+    e1.p = (u8) get_bits(block, &pos, 1);
+
+    u8 colors[16][4];
+    bc7_colors(e0, e1, colors);
+    for (s32 i = 0; i < 16; ++i) {
+        memcpy(out[i], colors[get_bits(block, &pos, i == 0 ? 3 : 4)], 4);
+    }
+}
+
+// =========================================
+// @Region: Levels.
+
+fn io_bc_block_size(IO_Image_Format format) -> u32 {
+    switch (format) {
+        case IO_Image_Format::BC1: return 8;
+        case IO_Image_Format::BC3: return 16;
+        case IO_Image_Format::BC7: return 16;
+        default:                   return 0;
+    }
+}
+
+fn io_bc_encode(IO_Image_Format format, const u8* rgba, s32 width, s32 height, u8* blocks) -> void {
+    u32 block_size = io_bc_block_size(format);
+    checkf(block_size > 0, "Error! Not a block compressed format!");
+    s32 blocks_x = (width + 3) / 4;
+    s32 blocks_y = (height + 3) / 4;
+
+    parallel_for(blocks_y, 4, [&](s32 first, s32 count) {
+        Bc_Pixels pixels;
+        for (s32 y = first; y < first + count; ++y) {
+            for (s32 x = 0; x < blocks_x; ++x) {
+                load_pixels(rgba, width, height, x, y, &pixels);
+                u8* out = blocks + ((u64) y * blocks_x + x) * block_size;
+                switch (format) {
+                    case IO_Image_Format::BC1: bc1_encode_color(pixels, true, out); break;
+                    case IO_Image_Format::BC3: bc3_encode_alpha(pixels, out); bc1_encode_color(pixels, false, out + 8); break;
+                    case IO_Image_Format::BC7: bc7_encode(pixels, out); break;
+                    default: break;
+                }
+            }
+        }
+    });
+}
+
+fn io_bc_decode(IO_Image_Format format, const u8* blocks, s32 width, s32 height, u8* rgba) -> void {
+    u32 block_size = io_bc_block_size(format);
+    checkf(block_size > 0, "Error! Not a block compressed format!");
+    s32 blocks_x = (width + 3) / 4;
+    s32 blocks_y = (height + 3) / 4;
+
+    for (s32 y = 0; y < blocks_y; ++y) {
+        for (s32 x = 0; x < blocks_x; ++x) {
+            const u8* block = blocks + ((u64) y * blocks_x + x) * block_size;
+            u8 colors[16][4];
+            switch (format) {
+                case IO_Image_Format::BC1: bc1_decode_color(block, false, colors); break;
+                case IO_Image_Format::BC3: bc3_decode_alpha(block, colors); bc1_decode_color(block + 8, true, colors); break;
+                case IO_Image_Format::BC7: bc7_decode(block, colors); break;
+                default: break;
+            }
+            store_pixels(colors, width, height, x, y, rgba);
+        }
+    }
+}
+
+fn io_bc_psnr(const u8* a, const u8* b, s32 width, s32 height) -> f32 {
+    u64 count = (u64) width * height * 4;
+    f64 sum = 0.0;
+    for (u64 i = 0; i < count; ++i) {
+        f64 d = (f64) a[i] - (f64) b[i];
+        sum += d * d;
+    }
+    if (sum == 0.0) {
+        return INFINITY;
+    }
+    f64 mse = sum / (f64) count;
+    return (f32) (10.0 * log10(255.0 * 255.0 / mse));
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "io_image.h"
+
+// @Note: Block compression of RGBA8 pixels for the cooked images (see io_image_cook). Every 4x4 block of pixels
+// becomes a couple of endpoint colors plus an index per pixel into the colors between them:
+//  - BC1: 565 endpoints, 2 bit indices. 8 bytes a block. Pixels with alpha < 128 turn into transparent black,
+//    exactly what a premultiplied texel wants, so it's fine for the sprites with hard edges.
+//  - BC3: the BC1 color block plus its own alpha block (8 bit endpoints, 3 bit indices). 16 bytes a block.
+//  - BC7: only mode 6, RGBA 7777 endpoints with a p bit each and 4 bit indices shared by the 4 channels. 16 bytes.
+// Edge blocks of sizes that aren't a multiple of 4 repeat the last column or row. The encoders only run while
+// cooking, the decoders are for the loads that want pixels (the arrays and the atlas) and for checking the quality.
+
+fn io_bc_block_size(IO_Image_Format format) -> u32;
+// @Note: rgba is width * height * 4 bytes, blocks is io_image_level_size(format, width, height). The block rows go
+// out to the job pool.
+fn io_bc_encode(IO_Image_Format format, const u8* rgba, s32 width, s32 height, u8* blocks) -> void;
+fn io_bc_decode(IO_Image_Format format, const u8* blocks, s32 width, s32 height, u8* rgba) -> void;
+// @Note: Peak signal to noise ratio (dB) between two RGBA8 images of the same size, over the 4 channels.
+// Infinite when they're the same. Above ~35 dB it's hard to tell them apart.
+fn io_bc_psnr(const u8* a, const u8* b, s32 width, s32 height) -> f32;
@@ -1,4 +1,6 @@
 #include "io_image.h"
+#include "io_bc.h"
+#include "base_jobs.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
@@ -9,23 +11,161 @@ fn io_image_white() -> const IO_Image* {
     return &image;
 }
 
+// @Note: The flip flag is per thread, the workers decode at the same time. stb's buffer only lives for the copy
+// into the storage, the same sizes come and go so the heap reuses it.
+static fn decode(const char* filename, IO_Image* image) -> bool {
+    IO_Cooked_Image cooked;
+    if (io_image_map_cooked(filename, &cooked)) {
+        IO_Image_Level level = cooked.levels[0];
+        u64 size = (u64) level.width * level.height * 4;
+        image->block = io_storage_alloc(size);
+        if (cooked.format == IO_Image_Format::RGBA8) {
+            memcpy(image->block.data, level.data, size);
+        } else {
+            io_bc_decode(cooked.format, level.data, level.width, level.height, image->block.data);
+        }
+        io_image_unmap_cooked(&cooked);
+        image->data = image->block.data;
+        image->width = level.width;
+        image->height = level.height;
+        image->channels = 4;
+        image->is_owner = true;
+        image->premultiplied = true;
+        return true;
+    }
+
+    stbi_set_flip_vertically_on_load_thread(1);
+    stbi_uc* data = stbi_load(filename, &image->width, &image->height, &image->channels, 0);
+    if (!data) {
+        return false;
+    }
+    u64 size = (u64) image->width * image->height * image->channels;
+    image->block = io_storage_alloc(size);
+    memcpy(image->block.data, data, size);
+    stbi_image_free(data);
+    image->data = image->block.data;
+    image->is_owner = true;
+    return true;
+}
+
 fn io_image_load(std::string_view filename, IO_Image* image) -> bool {
     if (filename.empty() || !image)
     return false;
 
-    stbi_set_flip_vertically_on_load(1);
-    stbi_uc* data = stbi_load(filename.data(), &image->width, &image->height, &image->channels, 0);
-    checkf(data, "IO_Image load failed!\n");
-    image->data = data; 
-    image->is_owner = true;
-    return true;
+    bool loaded = decode(std::string(filename).c_str(), image);
+    checkf(loaded, "IO_Image load failed!\n");
+    return loaded;
+}
+
+fn io_image_premultiply(IO_Image* image) -> void {
+    if (image->channels != 4 || image->premultiplied) {
+        return;
+    }
+    u8* pixel = image->data;
+    u8* end = image->data + (u64) image->width * image->height * 4;
+    for (; pixel < end; pixel += 4) {
+        u32 alpha = pixel[3];
+        pixel[0] = (u8) ((pixel[0] * alpha + 127u) / 255u);
+        pixel[1] = (u8) ((pixel[1] * alpha + 127u) / 255u);
+        pixel[2] = (u8) ((pixel[2] * alpha + 127u) / 255u);
+    }
+    image->premultiplied = true;
+}
+
+struct Image_Load {
+    std::string filename;
+    IO_Image image;
+    bool loaded = false;
+    Job_Counter counter;
+    u32 generation = 0;
+    bool used = false;
+};
+
+struct Image_Loads {
+    static constexpr u32 max_loads = 1024;
+    Image_Load loads[max_loads];
+    u32 cursor = 0; // Where the search for a free slot starts.
+} g_image_loads;
+
+static fn find_load(IO_Image_Ticket ticket) -> Image_Load* {
+    if (ticket.slot >= g_image_loads.max_loads) {
+        return nullptr;
+    }
+    Image_Load* load = &g_image_loads.loads[ticket.slot];
+    return load->used && load->generation == ticket.generation ? load : nullptr;
+}
+
+// @Note: Hands the image over and frees the slot.
+static fn take_load(Image_Load* load, IO_Image* image) -> bool {
+    bool loaded = load->loaded;
+    if (!ensuref(loaded, "IO_Image load failed! (%s)", load->filename.c_str())) {
+        *image = {};
+    } else {
+        *image = load->image;
+    }
+    load->image = {};
+    load->used = false;
+    ++load->generation;
+    return loaded;
+}
+
+fn io_image_load_async(std::string_view filename) -> IO_Image_Ticket {
+    IO_Image_Ticket ticket;
+    if (filename.empty()) {
+        return ticket;
+    }
+
+    for (u32 i = 0; i < g_image_loads.max_loads; ++i) {
+        u32 slot = (g_image_loads.cursor + i) % g_image_loads.max_loads;
+        if (!g_image_loads.loads[slot].used) {
+            ticket.slot = slot;
+            break;
+        }
+    }
+    if (!ensuref(ticket.slot != ~0u, "Error! More than %u images loading at once!", g_image_loads.max_loads)) {
+        return ticket;
+    }
+    g_image_loads.cursor = ticket.slot + 1;
+
+    Image_Load* load = &g_image_loads.loads[ticket.slot];
+    load->filename = filename;
+    load->used = true;
+    ticket.generation = load->generation;
+
+    Job_Fn job = [](void* data) {
+        Image_Load* load = (Image_Load*) data;
+        load->loaded = decode(load->filename.c_str(), &load->image);
+    };
+    jobs_run(job, load, &load->counter);
+    return ticket;
+}
+
+fn io_image_poll(IO_Image_Ticket ticket, IO_Image* image) -> IO_Image_Status {
+    Image_Load* load = find_load(ticket);
+    if (!load) {
+        return IO_Image_Status::Failed;
+    }
+    if (load->counter.pending.load(std::memory_order_acquire) > 0) {
+        return IO_Image_Status::Pending;
+    }
+    return take_load(load, image) ? IO_Image_Status::Ready : IO_Image_Status::Failed;
+}
+
+fn io_image_wait(IO_Image_Ticket ticket, IO_Image* image) -> bool {
+    Image_Load* load = find_load(ticket);
+    if (!load) {
+        return false;
+    }
+    jobs_wait(&load->counter);
+    return take_load(load, image);
 }
 
 fn io_image_free(IO_Image* image) -> void {
 
-    stbi_image_free(image->data);
+    io_storage_free(&image->block);
     image->data = nullptr;
     image->is_owner = false;
+    image->premultiplied = false;
 }
 
 fn io_image_valid(const IO_Image& image) -> bool {
@@ -34,4 +174,240 @@ fn io_image_valid(const IO_Image& image) -> bool {
         image.height   > 0 &&
         (image.channels == 1 || image.channels == 3 || image.channels == 4);
     return is_valid;
-}
\ No newline at end of file
+}
+
+// =========================================
+// @Region: Cooked images.
+
+static constexpr u32 cooked_magic = 0x474D4943u; // "CIMG".
+static constexpr u32 cooked_version = 2u;
+static constexpr u64 cooked_align = 16u;
+
+struct Cooked_Header {
+    u32 magic;
+    u32 version;
+    u64 source_time;
+    s32 width;
+    s32 height;
+    u32 level_count;
+    u32 format; // IO_Image_Format.
+    u64 level_offsets[IO_Cooked_Image::max_levels];
+};
+
+fn io_image_level_size(IO_Image_Format format, s32 width, s32 height) -> u64 {
+    if (format == IO_Image_Format::RGBA8) {
+        return (u64) width * height * 4;
+    }
+    return (u64) ((width + 3) / 4) * ((height + 3) / 4) * io_bc_block_size(format);
+}
+
+static fn next_level(s32 size) -> s32 {
+    return std::max(size / 2, 1);
+}
+
+fn io_image_cooked_path(std::string_view filename) -> std::string {
+    return std::string(filename) + ".cooked";
+}
+
+// @Note: Box filter over the premultiplied pixels (so the transparent ones don't bleed their color). Odd sizes
+// clamp the last column or row.
+static fn downsample(const u8* src, s32 width, s32 height, u8* dst) -> void {
+    s32 dst_width = next_level(width);
+    s32 dst_height = next_level(height);
+    for (s32 y = 0; y < dst_height; ++y) {
+        const u8* row0 = src + (u64) std::min(y * 2, height - 1) * width * 4;
+        const u8* row1 = src + (u64) std::min(y * 2 + 1, height - 1) * width * 4;
+        for (s32 x = 0; x < dst_width; ++x) {
+            s32 x0 = std::min(x * 2, width - 1) * 4;
+            s32 x1 = std::min(x * 2 + 1, width - 1) * 4;
+            for (s32 c = 0; c < 4; ++c) {
+                *dst++ = (u8) ((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+}
+
+// @Note: The RGBA8 mip chain of the source, what the cooked levels are made of: premultiplied, then box filtered.
+struct Pixel_Chain {
+    std::string pixels;
+    s32 widths[IO_Cooked_Image::max_levels];
+    s32 heights[IO_Cooked_Image::max_levels];
+    u64 offsets[IO_Cooked_Image::max_levels];
+    u32 level_count = 0;
+};
+
+static fn build_chain(std::string_view filename, Pixel_Chain* chain) -> bool {
+    std::string path(filename);
+    s32 width, height, channels;
+    stbi_set_flip_vertically_on_load_thread(1);
+    stbi_uc* data = stbi_load(path.c_str(), &width, &height, &channels, 4);
+    if (!data) {
+        return false;
+    }
+
+    u64 size = 0;
+    s32 level_width = width;
+    s32 level_height = height;
+    for (;;) {
+        chain->widths[chain->level_count] = level_width;
+        chain->heights[chain->level_count] = level_height;
+        chain->offsets[chain->level_count++] = size;
+        size += io_image_level_size(IO_Image_Format::RGBA8, level_width, level_height);
+        if ((level_width == 1 && level_height == 1) || chain->level_count == IO_Cooked_Image::max_levels) {
+            break;
+        }
+        level_width = next_level(level_width);
+        level_height = next_level(level_height);
+    }
+
+    chain->pixels.resize(size);
+    u8* pixels = (u8*) chain->pixels.data();
+    IO_Image level0;
+    level0.data = pixels;
+    level0.width = width;
+    level0.height = height;
+    level0.channels = 4;
+    memcpy(level0.data, data, io_image_level_size(IO_Image_Format::RGBA8, width, height));
+    stbi_image_free(data);
+    io_image_premultiply(&level0);
+
+    for (u32 i = 1; i < chain->level_count; ++i) {
+        downsample(pixels + chain->offsets[i - 1], chain->widths[i - 1], chain->heights[i - 1], pixels + chain->offsets[i]);
+    }
+    return true;
+}
+
+fn io_image_cook(std::string_view filename, IO_Image_Format format) -> bool {
+    Pixel_Chain chain;
+    if (!build_chain(filename, &chain)) {
+        return false;
+    }
+    s32 width = chain.widths[0];
+    s32 height = chain.heights[0];
+    if (width % 4 != 0 || height % 4 != 0) {
+        format = IO_Image_Format::RGBA8;
+    }
+
+    Cooked_Header header = {};
+    header.magic = cooked_magic;
+    header.version = cooked_version;
+    header.source_time = os_get_file_time(filename);
+    header.width = width;
+    header.height = height;
+    header.format = (u32) format;
+    header.level_count = chain.level_count;
+
+    u64 offset = (sizeof(header) + cooked_align - 1u) & ~(cooked_align - 1u);
+    for (u32 i = 0; i < chain.level_count; ++i) {
+        header.level_offsets[i] = offset;
+        offset = (offset + io_image_level_size(format, chain.widths[i], chain.heights[i]) + cooked_align - 1u) & ~(cooked_align - 1u);
+    }
+
+    std::string content(offset, '\0');
+    u8* out = (u8*) content.data();
+    memcpy(out, &header, sizeof(header));
+
+    const u8* pixels = (const u8*) chain.pixels.data();
+    for (u32 i = 0; i < chain.level_count; ++i) {
+        const u8* level = pixels + chain.offsets[i];
+        if (format == IO_Image_Format::RGBA8) {
+            memcpy(out + header.level_offsets[i], level, io_image_level_size(format, chain.widths[i], chain.heights[i]));
+        } else {
+            io_bc_encode(format, level, chain.widths[i], chain.heights[i], out + header.level_offsets[i]);
+        }
+    }
+
+    return os_write_entire_file(io_image_cooked_path(filename), content);
+}
+
+fn io_image_cooked_psnr(std::string_view filename, IO_Cooked_Psnr* psnr) -> bool {
+    IO_Cooked_Image cooked;
+    if (!io_image_map_cooked(filename, &cooked)) {
+        return false;
+    }
+    Pixel_Chain chain;
+    bool same = build_chain(filename, &chain) && (s32) chain.level_count == cooked.level_count;
+    for (s32 i = 0; same && i < cooked.level_count; ++i) {
+        same = chain.widths[i] == cooked.levels[i].width && chain.heights[i] == cooked.levels[i].height;
+    }
+    if (!same) {
+        io_image_unmap_cooked(&cooked);
+        return false;
+    }
+
+    *psnr = {};
+    psnr->level_count = cooked.level_count;
+    psnr->format = cooked.format;
+
+    // @Note: Over the whole chain the squared error of every pixel counts the same. So it's mostly the first level,
+    // the tiny ones (a block or less, where the blocks do worst) barely count.
+    f64 error = 0.0;
+    f64 pixel_count = 0.0;
+    std::string decoded;
+    for (s32 i = 0; i < cooked.level_count; ++i) {
+        const IO_Image_Level& level = cooked.levels[i];
+        const u8* pixels = level.data;
+        if (cooked.format != IO_Image_Format::RGBA8) {
+            decoded.resize(io_image_level_size(IO_Image_Format::RGBA8, level.width, level.height));
+            io_bc_decode(cooked.format, level.data, level.width, level.height, (u8*) decoded.data());
+            pixels = (const u8*) decoded.data();
+        }
+        const u8* reference = (const u8*) chain.pixels.data() + chain.offsets[i];
+        f64 level_pixels = (f64) level.width * level.height;
+        psnr->levels[i] = io_bc_psnr(reference, pixels, level.width, level.height);
+        psnr->widths[i] = level.width;
+        psnr->heights[i] = level.height;
+        error += level_pixels * 255.0 * 255.0 / pow(10.0, psnr->levels[i] / 10.0);
+        pixel_count += level_pixels;
+    }
+    psnr->chain = error > 0.0 ? (f32) (10.0 * log10(255.0 * 255.0 * pixel_count / error)) : INFINITY;
+    io_image_unmap_cooked(&cooked);
+    return true;
+}
+
+fn io_image_map_cooked(std::string_view filename, IO_Cooked_Image* image) -> bool {
+    *image = {};
+    u64 source_time = os_get_file_time(filename);
+    Mapped_File file = os_map_file(io_image_cooked_path(filename));
+    if (!file.data) {
+        return false;
+    }
+
+    Cooked_Header header = {};
+    if (file.size >= sizeof(header)) {
+        memcpy(&header, file.data, sizeof(header));
+    }
+    bool valid = header.magic == cooked_magic &&
+        header.version == cooked_version &&
+        header.source_time == source_time &&
+        header.width > 0 && header.height > 0 &&
+        header.format <= (u32) IO_Image_Format::BC7 &&
+        header.level_count >= 1u && header.level_count <= (u32) IO_Cooked_Image::max_levels;
+
+    IO_Image_Format format = (IO_Image_Format) header.format;
+    s32 width = header.width;
+    s32 height = header.height;
+    for (u32 i = 0; valid && i < header.level_count; ++i) {
+        u64 offset = header.level_offsets[i];
+        u64 size = io_image_level_size(format, width, height);
+        valid = offset % cooked_align == 0u && offset <= file.size && size <= file.size - offset;
+        image->levels[i] = { (const u8*) file.data + offset, width, height, size };
+        width = next_level(width);
+        height = next_level(height);
+    }
+    if (!valid) {
+        *image = {};
+        os_unmap_file(&file);
+        return false;
+    }
+
+    image->level_count = (s32) header.level_count;
+    image->format = format;
+    image->file = file;
+    return true;
+}
+
+fn io_image_unmap_cooked(IO_Cooked_Image* image) -> void {
+    os_unmap_file(&image->file);
+    *image = {};
+}
@@ -1,29 +1,91 @@
 #pragma once
 
-// @Pending: (He perdido la paciencia, voy a escribir esto en español).
-
-// Este modelo no es el que realmente querríamos para una app real.
-
-// Tanto la carga de imágenes como de meshes ha de ir a un buffer de
-// pixeles como de vertices respectivamente. No esto que tenemos.
-// Luego simplemente la info que tienen los propios objetos de 
-// IO_Image e IO_Mesh, serían los rangos de ese array.
-
-// A futuro, querríamos hacerlo dinámico y poder descargar imagenes, modelos
-// a placer, así que ahí las solución es trabajar por páginas.
-// Tener un modelo de almacenamiento con páginas pequeñas, medianas,
-// y grandes e ir colocando las imágenes y mallas en cada una. Así al librerar
-// libreraríamos por página. 
+#include "os_core.h"
+#include "io_storage.h"
 
+// @Note: The pixels live in the io storage pages (see io_storage.h), the image is a block of one of them.
+// io_image_free gives the block back.
 struct IO_Image {
     u8* data = nullptr;
     s32 width = 0;
     s32 height = 0;
     s32 channels = 0;
     bool is_owner = false;
+    bool premultiplied = false; // Color times alpha, cooked images come like that.
+    IO_Block block;
 };
 
 fn io_image_white() -> const IO_Image*;
 fn io_image_load(std::string_view filename, IO_Image* image) -> bool;
 fn io_image_free(IO_Image* image) -> void;
-fn io_image_valid(const IO_Image& image) -> bool;
\ No newline at end of file
+fn io_image_valid(const IO_Image& image) -> bool;
+// @Note: In place, only 4 channel images have something to do.
+fn io_image_premultiply(IO_Image* image) -> void;
+
+// @Note: Decoding on the job pool, so many files load in parallel while the main thread keeps going. The ticket is
+// good until poll says it's done (Ready or Failed) or wait returns, then the image is the caller's (io_image_free).
+// Call them from the main thread, only the decoding happens on the workers.
+struct IO_Image_Ticket {
+    u32 slot = ~0u;
+    u32 generation = 0;
+};
+
+enum class IO_Image_Status {
+    Pending,
+    Ready,
+    Failed,
+};
+
+fn io_image_load_async(std::string_view filename) -> IO_Image_Ticket;
+fn io_image_poll(IO_Image_Ticket ticket, IO_Image* image) -> IO_Image_Status;
+// @Note: Runs queued jobs while it waits. False if it failed (or the ticket was already used).
+fn io_image_wait(IO_Image_Ticket ticket, IO_Image* image) -> bool;
+
+// =========================================
+// @Region: Cooked images.
+
+// @Note: filename + ".cooked": a fixed header, then the mip chain (full size first, 16 byte aligned levels), as
+// RGBA8 pixels or as 4x4 blocks (see io_bc.h). Already flipped for gl and premultiplied, so it uploads as it is.
+// io_image_load reads the first level from it when it's there and up to date (same source write time), decoding
+// the blocks if it has to, texture_init maps every level.
+enum class IO_Image_Format : u8 {
+    RGBA8,
+    BC1,
+    BC3,
+    BC7,
+};
+
+struct IO_Image_Level {
+    const u8* data = nullptr;
+    s32 width = 0;
+    s32 height = 0;
+    u64 size = 0; // Bytes.
+};
+
+struct IO_Cooked_Image {
+    static constexpr s32 max_levels = 16;
+    IO_Image_Level levels[max_levels];
+    s32 level_count = 0;
+    IO_Image_Format format = IO_Image_Format::RGBA8;
+    Mapped_File file;
+};
+
+fn io_image_level_size(IO_Image_Format format, s32 width, s32 height) -> u64;
+fn io_image_cooked_path(std::string_view filename) -> std::string;
+// @Note: The block formats need sizes multiple of 4, other images are cooked as RGBA8 whatever the format asked.
+fn io_image_cook(std::string_view filename, IO_Image_Format format = IO_Image_Format::RGBA8) -> bool;
+// @Note: PSNR (dB, see io_bc_psnr) of the cooked levels against the chain the cook started from. Infinite for RGBA8.
+struct IO_Cooked_Psnr {
+    f32 levels[IO_Cooked_Image::max_levels];
+    s32 widths[IO_Cooked_Image::max_levels];
+    s32 heights[IO_Cooked_Image::max_levels];
+    s32 level_count = 0;
+    f32 chain = 0.f; // Over every level, so mostly the first one.
+    IO_Image_Format format = IO_Image_Format::RGBA8;
+};
+
+// @Note: Decodes every level of the cooked file. False if it's missing or stale.
+fn io_image_cooked_psnr(std::string_view filename, IO_Cooked_Psnr* psnr) -> bool;
+// @Note: False if there's no cooked file or it's older than the source.
+fn io_image_map_cooked(std::string_view filename, IO_Cooked_Image* image) -> bool;
+fn io_image_unmap_cooked(IO_Cooked_Image* image) -> void;
@@ -1,11 +1,757 @@
 #include "io_model.h"
 #include "os_core.h"
+#include "base_jobs.h"
+
+#include <algorithm>
 
 #define WIN32_MEAN_AND_LEAN
 #include <Windows.h>
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "tiny_obj_loader.h"
 
+// @Note: Open addressing, the slots hold vertex indices (empty_slot if free) plus the upper half of their hash, so
+// most of the misses don't touch the vertices. Sized for the worst case (no vertex shared at all) at half load,
+// so it never grows.
+struct Vertex_Table {
+    static constexpr u32 empty_slot = ~0u;
+    struct Slot {
+        u32 index;
+        u32 tag;
+    };
+    Slot* slots = nullptr;
+    u32 cap = 0;
+    Allocator* allocator = nullptr;
+};
+
+static fn vertex_table_init(Vertex_Table* table, u32 max_vertices, Allocator* allocator) -> void {
+    table->cap = 16u;
+    while (table->cap < 2u * max_vertices) {
+        table->cap *= 2u;
+    }
+    table->allocator = allocator;
+    table->slots = (Vertex_Table::Slot*) mem_alloc(allocator, sizeof(Vertex_Table::Slot) * table->cap, alignof(Vertex_Table::Slot));
+    memset(table->slots, 0xFF, sizeof(Vertex_Table::Slot) * table->cap);
+}
+
+static fn vertex_table_done(Vertex_Table* table) -> void {
+    mem_free(table->allocator, table->slots, sizeof(Vertex_Table::Slot) * table->cap);
+    *table = {};
+}
+
+// @Note: Bitwise, so only exact copies merge (the same obj corner or the same values written twice).
+static fn vertex_equal(const IO_Model_VTX& a, const IO_Model_VTX& b) -> bool {
+    return memcmp(&a, &b, sizeof(IO_Model_VTX)) == 0;
+}
+
+// @Note: A word at a time (hash_str goes byte by byte), with a final mix so the low bits used by the table are good.
+static fn vertex_hash(const IO_Model_VTX& v) -> u64 {
+    constexpr u32 word_count = sizeof(IO_Model_VTX) / sizeof(u32);
+    u32 words[word_count];
+    memcpy(words, &v, sizeof(words));
+    u64 hash = 0x9E3779B97F4A7C15ull;
+    for (u32 i = 0; i < word_count; ++i) {
+        hash = (hash ^ words[i]) * 0xFF51AFD7ED558CCDull;
+    }
+    hash ^= hash >> 32;
+    hash *= 0xC4CEB9FE1A85EC53ull;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+// @Note: Returns the index of v, appending it if it's new. hash is vertex_hash(v).
+static fn vertex_table_add(Vertex_Table* table, Array<IO_Model_VTX>* vertices, const IO_Model_VTX& v, u64 hash) -> u32 {
+    u32 mask = table->cap - 1u;
+    u32 tag = (u32) (hash >> 32);
+    u32 i = (u32) hash & mask;
+    while (table->slots[i].index != Vertex_Table::empty_slot) {
+        const Vertex_Table::Slot& slot = table->slots[i];
+        if (slot.tag == tag && vertex_equal(vertices->data[slot.index], v)) {
+            return slot.index;
+        }
+        i = (i + 1u) & mask;
+    }
+    u32 index = vertices->count;
+    append(vertices, v);
+    table->slots[i] = { index, tag };
+    return index;
+}
+
+// =========================================
+// @Region: OBJ parsing.
+// =========================================
+
+// @Note: The file is split in line aligned chunks parsed in parallel. Each chunk keeps its own v/vt/vn and faces, the
+// indices are resolved once every chunk knows how many v/vt/vn came before it. MTL files still go through tinyobj.
+
+constexpr s32 obj_missing = INT32_MIN; // No vt or vn in the corner.
+
+struct Obj_Corner {
+    s32 index[3];    // v, vt, vn. 0 based.
+    u8 relative = 0; // Bit i: index[i] came negative, it's relative to the start of the chunk.
+};
+
+struct Obj_Event {
+    enum Kind : u8 { Group, Material } kind;
+    u32 corner; // Applies from this corner on.
+    std::string_view name;
+};
+
+struct Obj_Chunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    Array<Vec3> positions;
+    Array<Vec2> uvs;
+    Array<Vec3> normals;
+    Array<Obj_Corner> corners; // 3 per triangle.
+    Array<Obj_Event> events;
+    std::string_view mtllib;
+    u32 bases[3] = {}; // v, vt, vn before this chunk.
+    bool bad_index = false;
+};
+
+static fn obj_chunk_done(Obj_Chunk* chunk) -> void {
+    reset(&chunk->positions);
+    reset(&chunk->uvs);
+    reset(&chunk->normals);
+    reset(&chunk->corners);
+    reset(&chunk->events);
+}
+
+static fn is_space(char c) -> bool {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static fn is_digit(char c) -> bool {
+    return c >= '0' && c <= '9';
+}
+
+static fn skip_spaces(const char* p, const char* end) -> const char* {
+    while (p < end && is_space(*p)) {
+        ++p;
+    }
+    return p;
+}
+
+// @Note: Up to 19 significant digits in a u64, then one scale by a power of 10. Exact for the usual obj numbers
+// (they fit in a double with a |exponent| <= 22), at most an ulp off for the rest.
+static fn parse_f32(const char*& p, const char* end) -> f32 {
+    constexpr f64 pow10[] = {
+        1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+    };
+
+    p = skip_spaces(p, end);
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    u64 mantissa = 0;
+    s32 digits = 0;
+    s32 exponent = 0;
+    for (; p < end && is_digit(*p); ++p) {
+        if (digits < 19) {
+            mantissa = mantissa * 10u + (u64) (*p - '0');
+            digits += mantissa != 0u;
+        } else {
+            ++exponent;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && is_digit(*p); ++p) {
+            if (digits < 19) {
+                mantissa = mantissa * 10u + (u64) (*p - '0');
+                digits += mantissa != 0u;
+                --exponent;
+            }
+        }
+    }
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool exp_negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            exp_negative = *p == '-';
+            ++p;
+        }
+        s32 value = 0;
+        for (; p < end && is_digit(*p); ++p) {
+            value = std::min(value * 10 + (*p - '0'), 10000);
+        }
+        exponent += exp_negative ? -value : value;
+    }
+
+    f64 result = (f64) mantissa;
+    if (exponent >= 0) {
+        result *= exponent <= 22 ? pow10[exponent] : pow(10.0, exponent);
+    } else {
+        result /= exponent >= -22 ? pow10[-exponent] : pow(10.0, -exponent);
+    }
+    return (f32) (negative ? -result : result);
+}
+
+static fn parse_s32(const char*& p, const char* end, s32* value) -> bool {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p >= end || !is_digit(*p)) {
+        return false;
+    }
+    s32 result = 0;
+    for (; p < end && is_digit(*p); ++p) {
+        result = result * 10 + (*p - '0');
+    }
+    *value = negative ? -result : result;
+    return true;
+}
+
+static fn parse_name(const char* p, const char* end) -> std::string_view {
+    p = skip_spaces(p, end);
+    const char* last = end;
+    while (last > p && is_space(last[-1])) {
+        --last;
+    }
+    return std::string_view(p, (size_t) (last - p));
+}
+
+static fn starts_with(const char* p, const char* end, std::string_view word) -> bool {
+    return (size_t) (end - p) > word.size() && memcmp(p, word.data(), word.size()) == 0 && is_space(p[word.size()]);
+}
+
+// @Note: "v", "v/vt", "v//vn" or "v/vt/vn". 1 based, negative counts back from the last one read.
+static fn parse_corner(Obj_Chunk* chunk, const char*& p, const char* end, Obj_Corner* corner) -> bool {
+    const u32 counts[3] = { chunk->positions.count, chunk->uvs.count, chunk->normals.count };
+    corner->relative = 0;
+    for (s32 i = 0; i < 3; ++i) {
+        corner->index[i] = obj_missing;
+        if (i > 0) {
+            if (p >= end || *p != '/') {
+                continue;
+            }
+            ++p;
+            if (p < end && *p == '/') {
+                continue; // v//vn
+            }
+        }
+        s32 value = 0;
+        if (!parse_s32(p, end, &value)) {
+            if (i == 0) {
+                return false;
+            }
+            continue;
+        }
+        if (value > 0) {
+            corner->index[i] = value - 1;
+        } else if (value < 0) {
+            corner->index[i] = (s32) counts[i] + value;
+            corner->relative |= (u8) (1u << i);
+        } else {
+            chunk->bad_index = true;
+        }
+    }
+    return true;
+}
+
+static fn parse_chunk(Obj_Chunk* chunk) -> void {
+    const char* p = chunk->begin;
+    const char* end = chunk->end;
+
+    while (p < end) {
+        const char* line_end = (const char*) memchr(p, '\n', (size_t) (end - p));
+        if (!line_end) {
+            line_end = end;
+        }
+        const char* q = skip_spaces(p, line_end);
+
+        if (line_end - q >= 2) {
+            if (q[0] == 'v' && is_space(q[1])) {
+                q += 2;
+                Vec3& v = append(&chunk->positions);
+                v.x = parse_f32(q, line_end);
+                v.y = parse_f32(q, line_end);
+                v.z = parse_f32(q, line_end);
+            } else if (q[0] == 'v' && q[1] == 't') {
+                q += 2;
+                Vec2& vt = append(&chunk->uvs);
+                vt.x = parse_f32(q, line_end);
+                vt.y = parse_f32(q, line_end);
+            } else if (q[0] == 'v' && q[1] == 'n') {
+                q += 2;
+                Vec3& vn = append(&chunk->normals);
+                vn.x = parse_f32(q, line_end);
+                vn.y = parse_f32(q, line_end);
+                vn.z = parse_f32(q, line_end);
+            } else if (q[0] == 'f' && is_space(q[1])) {
+                // @Note: Polygons as a fan around the first corner.
+                q += 2;
+                Obj_Corner first, prev, corner;
+                s32 corner_count = 0;
+                for (q = skip_spaces(q, line_end); q < line_end; q = skip_spaces(q, line_end)) {
+                    if (!parse_corner(chunk, q, line_end, &corner)) {
+                        break;
+                    }
+                    if (corner_count >= 2) {
+                        append(&chunk->corners, first);
+                        append(&chunk->corners, prev);
+                        append(&chunk->corners, corner);
+                    }
+                    if (corner_count == 0) {
+                        first = corner;
+                    }
+                    prev = corner;
+                    ++corner_count;
+                }
+            } else if ((q[0] == 'o' || q[0] == 'g') && is_space(q[1])) {
+                append(&chunk->events, { Obj_Event::Group, chunk->corners.count, parse_name(q + 1, line_end) });
+            } else if (starts_with(q, line_end, "usemtl")) {
+                append(&chunk->events, { Obj_Event::Material, chunk->corners.count, parse_name(q + 6, line_end) });
+            } else if (starts_with(q, line_end, "mtllib") && chunk->mtllib.empty()) {
+                chunk->mtllib = parse_name(q + 6, line_end);
+            }
+        }
+
+        p = line_end + 1;
+    }
+}
+
+struct Obj_Attribs {
+    const Vec3* positions;
+    const Vec2* uvs;
+    const Vec3* normals;
+    bool normals_as_colors;
+};
+
+// @Note: Missing (or bad) indices read as zeros.
+static fn obj_vertex(const Obj_Attribs& attribs, const Obj_Corner& corner) -> IO_Model_VTX {
+    IO_Model_VTX v;
+    if (corner.index[0] != obj_missing) {
+        v.pos = attribs.positions[corner.index[0]];
+    }
+    if (corner.index[1] != obj_missing) {
+        v.uv = attribs.uvs[corner.index[1]];
+    }
+    if (corner.index[2] != obj_missing) {
+        v.normal = attribs.normals[corner.index[2]];
+    }
+    v.color = attribs.normals_as_colors ? Vec4{ v.normal.x, v.normal.y, v.normal.z, 1.f } : Vec4(Color.White);
+    return v;
+}
+
+// @Note: Makes the indices absolute and checks them.
+static fn resolve_chunk(Obj_Chunk* chunk, const u32 totals[3]) -> void {
+    for (Obj_Corner& corner : chunk->corners) {
+        for (s32 i = 0; i < 3; ++i) {
+            s32& index = corner.index[i];
+            if (index == obj_missing) {
+                continue;
+            }
+            if (corner.relative & (1u << i)) {
+                index += (s32) chunk->bases[i];
+            }
+            if (index < 0 || (u32) index >= totals[i]) {
+                chunk->bad_index = true;
+                index = obj_missing;
+            }
+        }
+    }
+}
+
+static fn load_obj(std::string_view filename, IO_Model* model) -> bool {
+    Mapped_File file = os_map_file(filename);
+    if (!file.data) {
+        checkf(false, "Mesh could not be loaded!");
+        return false;
+    }
+
+    // Split in line aligned chunks, a few per thread so a slow one doesn't leave the rest waiting.
+    constexpr u64 min_chunk_size = 256 * 1024;
+    constexpr s32 max_chunks = 256;
+    s32 chunk_count = (s32) std::min<u64>(std::max<u64>(file.size / min_chunk_size, 1u), (u64) (jobs_worker_count() + 1) * 4u);
+    chunk_count = std::min(chunk_count, max_chunks);
+
+    Obj_Chunk* chunks = new Obj_Chunk[chunk_count];
+    const char* file_end = file.data + file.size;
+    const char* cursor = file.data;
+    for (s32 i = 0; i < chunk_count; ++i) {
+        chunks[i].begin = cursor;
+        const char* split = i == chunk_count - 1 ? file_end : std::max(cursor, file.data + file.size * (i + 1) / chunk_count);
+        const char* line_end = split < file_end ? (const char*) memchr(split, '\n', (size_t) (file_end - split)) : nullptr;
+        cursor = line_end ? line_end + 1 : file_end;
+        chunks[i].end = cursor;
+    }
+
+    parallel_for(chunk_count, 1, [&](s32 first, s32 count) {
+        for (s32 i = first; i < first + count; ++i) {
+            parse_chunk(&chunks[i]);
+        }
+    });
+
+    // Concatenate the v/vt/vn, every chunk copies its own part.
+    u32 totals[3] = {};
+    for (s32 i = 0; i < chunk_count; ++i) {
+        Obj_Chunk& chunk = chunks[i];
+        chunk.bases[0] = totals[0];
+        chunk.bases[1] = totals[1];
+        chunk.bases[2] = totals[2];
+        totals[0] += chunk.positions.count;
+        totals[1] += chunk.uvs.count;
+        totals[2] += chunk.normals.count;
+    }
+
+    // @Note: Same allocator as the model arrays, the load's scratch arena (see io_model_load). The chunks were
+    // parsed on the workers, so theirs stay on the heap.
+    Allocator* scratch = model->vertices.allocator;
+    Array<Vec3> positions;
+    Array<Vec2> uvs;
+    Array<Vec3> normals;
+    positions.allocator = scratch;
+    uvs.allocator = scratch;
+    normals.allocator = scratch;
+    reserve(&positions, totals[0]);
+    reserve(&uvs, totals[1]);
+    reserve(&normals, totals[2]);
+    positions.count = totals[0];
+    uvs.count = totals[1];
+    normals.count = totals[2];
+
+    parallel_for(chunk_count, 1, [&](s32 first, s32 count) {
+        for (s32 i = first; i < first + count; ++i) {
+            Obj_Chunk& chunk = chunks[i];
+            // A chunk with only faces has no v/vt/vn, and memcpy wants valid pointers even for 0 bytes.
+            if (chunk.positions.count > 0) {
+                memcpy(positions.data + chunk.bases[0], chunk.positions.data, chunk.positions.count * sizeof(Vec3));
+            }
+            if (chunk.uvs.count > 0) {
+                memcpy(uvs.data + chunk.bases[1], chunk.uvs.data, chunk.uvs.count * sizeof(Vec2));
+            }
+            if (chunk.normals.count > 0) {
+                memcpy(normals.data + chunk.bases[2], chunk.normals.data, chunk.normals.count * sizeof(Vec3));
+            }
+            resolve_chunk(&chunk, totals);
+        }
+    });
+
+    // Materials.
+    std::map<std::string, s32> material_map;
+    std::vector<tinyobj::material_t> materials;
+    for (s32 i = 0; i < chunk_count; ++i) {
+        if (!chunks[i].mtllib.empty()) {
+            std::ifstream mtl_file(model->dirpath + "/" + std::string(chunks[i].mtllib));
+            if (mtl_file) {
+                std::string warn, err;
+                tinyobj::LoadMtl(&material_map, &materials, &mtl_file, &warn, &err);
+            }
+            break;
+        }
+    }
+
+    // Build the vertices and shapes. A shape ends at each o/g and usemtl, so every shape has one material.
+    u32 corner_total = 0;
+    u32 event_total = 0;
+    bool bad_index = false;
+    for (s32 i = 0; i < chunk_count; ++i) {
+        corner_total += chunks[i].corners.count;
+        event_total += chunks[i].events.count;
+        bad_index |= chunks[i].bad_index;
+    }
+    if (bad_index) {
+        logf("Warning! %s has out of range indices, they were ignored.", model->name.c_str());
+    }
+
+    Obj_Attribs attribs = { positions.data, uvs.data, normals.data, model->normals_as_colors };
+    reserve(&model->vertices, model->vertices.count + std::min(corner_total, totals[0] * 2u));
+    reserve(&model->elems, model->elems.count + corner_total);
+    reserve(&model->shapes, model->shapes.count + event_total + 1u);
+
+    Vertex_Table table;
+    vertex_table_init(&table, corner_total, scratch);
+
+    s32 material = -1;
+    u32 shape_offset = model->elems.count;
+    fn close_shape = [&]() {
+        u32 index_count = model->elems.count - shape_offset;
+        if (index_count == 0) {
+            return;
+        }
+        IO_Model_Shape& s = append(&model->shapes);
+        s.index_offset = shape_offset;
+        s.index_count = index_count;
+        s.lods[0] = { shape_offset, index_count, 0.0f };
+        s.material_index = material >= 0 ? (u32) material : 0u;
+        if (material >= 0 && material < (s32) materials.size()) {
+            s.name = materials[material].name;
+            s.textures.ambient = materials[material].ambient_texname;
+            s.textures.diffuse = materials[material].diffuse_texname;
+        }
+        shape_offset = model->elems.count;
+    };
+
+    fn apply_event = [&](const Obj_Event& e) {
+        close_shape();
+        if (e.kind == Obj_Event::Material) {
+            auto it = material_map.find(std::string(e.name));
+            material = it != material_map.end() ? it->second : -1;
+        }
+    };
+
+    for (s32 i = 0; i < chunk_count; ++i) {
+        const Obj_Chunk& chunk = chunks[i];
+        u32 event = 0;
+        for (u32 c = 0; c < chunk.corners.count; ++c) {
+            for (; event < chunk.events.count && chunk.events.data[event].corner == c; ++event) {
+                apply_event(chunk.events.data[event]);
+            }
+
+            IO_Model_VTX v = obj_vertex(attribs, chunk.corners.data[c]);
+            append(&model->elems, vertex_table_add(&table, &model->vertices, v, vertex_hash(v)));
+        }
+        // The ones after the last face of the chunk.
+        for (; event < chunk.events.count; ++event) {
+            apply_event(chunk.events.data[event]);
+        }
+    }
+    close_shape();
+
+    vertex_table_done(&table);
+    reset(&positions);
+    reset(&uvs);
+    reset(&normals);
+    for (s32 i = 0; i < chunk_count; ++i) {
+        obj_chunk_done(&chunks[i]);
+    }
+    delete[] chunks;
+    os_unmap_file(&file);
+
+    if (model->lod_count > 1) {
+        io_model_build_lods(model, model->lod_count);
+    }
+    if (model->optimize) {
+        io_model_optimize(model);
+    }
+    
+    return true;
+}
+
+// =========================================
+// @Region: Cooked models.
+
+static constexpr u32 cooked_magic = 0x4C444D43u; // "CMDL".
+static constexpr u32 cooked_version = 2u;
+static constexpr u64 cooked_align = 16u;
+
+enum Cooked_Flags : u32 {
+    Cooked_Normals_As_Colors = 1u << 0,
+    Cooked_Optimized         = 1u << 1,
+    Cooked_Lod_Count_Shift   = 8u, // The lod_count asked for, from here up.
+};
+
+struct Cooked_Header {
+    u32 magic;
+    u32 version;
+    u32 vertex_size; // sizeof(IO_Model_VTX) when cooked, a layout change makes it stale.
+    u32 flags;
+    u64 source_time;
+    u32 vertex_count;
+    u32 elem_count;
+    u32 shape_count;
+    u32 strings_size;
+    u64 vertices_offset;
+    u64 elems_offset;
+    u64 shapes_offset;
+    u64 strings_offset;
+};
+
+// @Note: The strings go as offset and size into the string section.
+struct Cooked_Shape {
+    u32 index_offset;
+    u32 index_count;
+    u32 material_index;
+    u32 name[2];
+    u32 ambient[2];
+    u32 diffuse[2];
+    u32 lod_count;
+    IO_Model_Lod lods[io_model_max_lods];
+};
+
+static fn cooked_flags(const IO_Model& model) -> u32 {
+    return (model.normals_as_colors ? Cooked_Normals_As_Colors : 0u) | (model.optimize ? Cooked_Optimized : 0u) |
+        (model.lod_count << Cooked_Lod_Count_Shift);
+}
+
+static fn align_up(u64 value, u64 align) -> u64 {
+    return (value + align - 1u) & ~(align - 1u);
+}
+
+static fn cooked_section_fits(const Mapped_File& file, u64 offset, u64 size) -> bool {
+    return offset % cooked_align == 0u && offset <= file.size && size <= file.size - offset;
+}
+
+fn io_model_cooked_path(std::string_view filename) -> std::string {
+    return std::string(filename) + ".cooked";
+}
+
+// @Note: Only the header and the shape table are checked and copied, the big sections are used as they are.
+static fn load_cooked(std::string_view filename, IO_Model* model) -> bool {
+    u64 source_time = os_get_file_time(filename);
+    Mapped_File file = os_map_file(io_model_cooked_path(filename));
+    if (!file.data) {
+        return false;
+    }
+
+    Cooked_Header header = {};
+    if (file.size >= sizeof(header)) {
+        memcpy(&header, file.data, sizeof(header));
+    }
+    bool valid = header.magic == cooked_magic &&
+        header.version == cooked_version &&
+        header.vertex_size == sizeof(IO_Model_VTX) &&
+        header.flags == cooked_flags(*model) &&
+        header.source_time == source_time &&
+        cooked_section_fits(file, header.vertices_offset, (u64) header.vertex_count * sizeof(IO_Model_VTX)) &&
+        cooked_section_fits(file, header.elems_offset, (u64) header.elem_count * sizeof(u32)) &&
+        cooked_section_fits(file, header.shapes_offset, (u64) header.shape_count * sizeof(Cooked_Shape)) &&
+        cooked_section_fits(file, header.strings_offset, header.strings_size);
+
+    const Cooked_Shape* shapes = (const Cooked_Shape*) (file.data + header.shapes_offset);
+    for (u32 i = 0; valid && i < header.shape_count; ++i) {
+        const Cooked_Shape& shape = shapes[i];
+        valid = (u64) shape.index_offset + shape.index_count <= header.elem_count &&
+            (u64) shape.name[0] + shape.name[1] <= header.strings_size &&
+            (u64) shape.ambient[0] + shape.ambient[1] <= header.strings_size &&
+            (u64) shape.diffuse[0] + shape.diffuse[1] <= header.strings_size &&
+            shape.lod_count >= 1u && shape.lod_count <= io_model_max_lods;
+        for (u32 lod = 0; valid && lod < shape.lod_count; ++lod) {
+            valid = (u64) shape.lods[lod].index_offset + shape.lods[lod].index_count <= header.elem_count;
+        }
+    }
+    if (!valid) {
+        os_unmap_file(&file);
+        return false;
+    }
+
+    const char* strings = file.data + header.strings_offset;
+    fn string_at = [&](const u32 range[2]) {
+        return std::string(strings + range[0], range[1]);
+    };
+    reserve(&model->shapes, header.shape_count);
+    for (u32 i = 0; i < header.shape_count; ++i) {
+        IO_Model_Shape& shape = append(&model->shapes);
+        shape.name = string_at(shapes[i].name);
+        shape.textures.ambient = string_at(shapes[i].ambient);
+        shape.textures.diffuse = string_at(shapes[i].diffuse);
+        shape.index_offset = shapes[i].index_offset;
+        shape.index_count = shapes[i].index_count;
+        shape.material_index = shapes[i].material_index;
+        shape.lod_count = shapes[i].lod_count;
+        memcpy(shape.lods, shapes[i].lods, sizeof(shape.lods));
+    }
+
+    model->vertices.data = (IO_Model_VTX*) (file.data + header.vertices_offset);
+    model->vertices.count = header.vertex_count;
+    model->vertices.cap = 0;
+    model->elems.data = (u32*) (file.data + header.elems_offset);
+    model->elems.count = header.elem_count;
+    model->elems.cap = 0;
+    model->cooked = file;
+    return true;
+}
+
+fn io_model_cook(const IO_Model& model, std::string_view source_filename) -> bool {
+    std::string strings;
+    Array<Cooked_Shape> shapes;
+    reserve(&shapes, model.shapes.count);
+    fn add_string = [&](const std::string& text, u32 range[2]) {
+        range[0] = (u32) strings.size();
+        range[1] = (u32) text.size();
+        strings += text;
+    };
+    for (const IO_Model_Shape& shape : model.shapes) {
+        Cooked_Shape& cooked = append(&shapes);
+        cooked.index_offset = shape.index_offset;
+        cooked.index_count = shape.index_count;
+        cooked.material_index = shape.material_index;
+        cooked.lod_count = shape.lod_count;
+        memcpy(cooked.lods, shape.lods, sizeof(cooked.lods));
+        add_string(shape.name, cooked.name);
+        add_string(shape.textures.ambient, cooked.ambient);
+        add_string(shape.textures.diffuse, cooked.diffuse);
+    }
+
+    Cooked_Header header = {};
+    header.magic = cooked_magic;
+    header.version = cooked_version;
+    header.vertex_size = sizeof(IO_Model_VTX);
+    header.flags = cooked_flags(model);
+    header.source_time = os_get_file_time(source_filename);
+    header.vertex_count = model.vertices.count;
+    header.elem_count = model.elems.count;
+    header.shape_count = shapes.count;
+    header.strings_size = (u32) strings.size();
+    header.vertices_offset = align_up(sizeof(header), cooked_align);
+    header.elems_offset = align_up(header.vertices_offset + (u64) header.vertex_count * sizeof(IO_Model_VTX), cooked_align);
+    header.shapes_offset = align_up(header.elems_offset + (u64) header.elem_count * sizeof(u32), cooked_align);
+    header.strings_offset = align_up(header.shapes_offset + (u64) header.shape_count * sizeof(Cooked_Shape), cooked_align);
+
+    std::string content(header.strings_offset + header.strings_size, '\0');
+    char* out = content.data();
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + header.vertices_offset, model.vertices.data, (u64) header.vertex_count * sizeof(IO_Model_VTX));
+    memcpy(out + header.elems_offset, model.elems.data, (u64) header.elem_count * sizeof(u32));
+    memcpy(out + header.shapes_offset, shapes.data, (u64) header.shape_count * sizeof(Cooked_Shape));
+    memcpy(out + header.strings_offset, strings.data(), strings.size());
+    reset(&shapes);
+
+    return os_write_entire_file(io_model_cooked_path(source_filename), content);
+}
+
+// @Note: Growing a view copies it out (see Array), into allocator.
+template<typename T>
+static fn own_array(Array<T>* array, Allocator* allocator) -> void {
+    if (array->cap == 0) {
+        array->allocator = allocator;
+        if (array->count > 0) {
+            reserve(array, array->count);
+        }
+    }
+}
+
+// @Note: Back to arrays that can grow (from the storage blocks or the cooked mapping), on the heap if allocator is null.
+static fn own_arrays(IO_Model* model, Allocator* allocator = nullptr) -> void {
+    own_array(&model->vertices, allocator);
+    own_array(&model->elems, allocator);
+    io_storage_free(&model->vertex_block);
+    io_storage_free(&model->elem_block);
+    os_unmap_file(&model->cooked);
+}
+
+// @Note: The other way around, the arrays become views of storage blocks.
+static fn store_arrays(IO_Model* model) -> void {
+    u64 vertex_size = (u64) model->vertices.count * sizeof(IO_Model_VTX);
+    u64 elem_size = (u64) model->elems.count * sizeof(u32);
+    model->vertex_block = io_storage_alloc(vertex_size);
+    model->elem_block = io_storage_alloc(elem_size);
+    if (vertex_size > 0) {
+        memcpy(model->vertex_block.data, model->vertices.data, vertex_size);
+    }
+    if (elem_size > 0) {
+        memcpy(model->elem_block.data, model->elems.data, elem_size);
+    }
+
+    u32 vertex_count = model->vertices.count;
+    u32 elem_count = model->elems.count;
+    reset(&model->vertices);
+    reset(&model->elems);
+    // The views go back to the heap if they're ever owned again.
+    model->vertices.allocator = nullptr;
+    model->elems.allocator = nullptr;
+    model->vertices.data = (IO_Model_VTX*) model->vertex_block.data;
+    model->vertices.count = vertex_count;
+    model->elems.data = (u32*) model->elem_block.data;
+    model->elems.count = elem_count;
+}
+
 fn io_model_load(std::string_view filename, IO_Model* model) -> bool {
     if (filename.empty() || !model) {
         return false;
@@ -16,83 +762,633 @@ fn io_model_load(std::string_view filename, IO_Model* model) -> bool {
     model->dirpath = info.dirpath;
     model->name = info.name;
 
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string warn, err;
-
-    bool ok = tinyobj::LoadObj(
-        &attrib,
-        &shapes,
-        &materials,
-        &warn,
-        &err,
-        filename.data(),
-        model->dirpath.data()
-    );
-
-    if (!ok)
-    {
-        checkf(false, "Mesh could not be loaded!");
-        return false;
+    bool empty = model->vertices.count == 0 && model->elems.count == 0 && model->shapes.count == 0;
+    if (empty && load_cooked(filename, model)) {
+        return true;
+    }
+
+    // @Note: The model is built in a scratch arena: the merged arrays, the lods and the optimize pass with all their
+    // temporaries. store_arrays is then the one copy into the storage blocks, and the arena goes in a few frees.
+    Arena scratch;
+    arena_init(&scratch, 8ull << 20);
+    own_arrays(model, arena_allocator(&scratch));
+    bool loaded = load_obj(filename, model);
+    if (loaded && empty && model->cook && !io_model_cook(*model, filename)) {
+        logf("Warning! %s could not be cooked.", model->name.c_str());
+    }
+    store_arrays(model);
+    arena_done(&scratch);
+    return loaded;
+}
+
+fn io_model_free(IO_Model* model) -> void {
+    // @Note: Heap arrays only if the model was built (or touched) after loading.
+    if (model->vertices.cap > 0) {
+        reset(&model->vertices);
+    }
+    if (model->elems.cap > 0) {
+        reset(&model->elems);
+    }
+    model->vertices = {};
+    model->elems = {};
+    io_storage_free(&model->vertex_block);
+    io_storage_free(&model->elem_block);
+    os_unmap_file(&model->cooked);
+    reset(&model->shapes);
+}
+
+fn io_model_pack(const IO_Model& model, Array<IO_Model_Packed_VTX>* vertices) -> void {
+    reset_keeping_memory(vertices);
+    reserve(vertices, model.vertices.count);
+    for (const IO_Model_VTX& v : model.vertices) {
+        IO_Model_Packed_VTX& packed = append(vertices);
+        packed.pos    = v.pos;
+        packed.uv     = pack_half2(v.uv.x, v.uv.y);
+        packed.normal = pack_snorm1010102(v.normal);
+        packed.color  = pack_unorm8x4(v.color);
+    }
+}
+
+// @Note: Tipsify (Sander, Nehab, Barczak 2007). Walks the mesh fanning around a vertex, then picks the next fan
+// among the vertices just emitted, preferring the ones still in the cache and with few triangles left. Linear time.
+// Reorders the triangles of [elems, elems + elem_count), the vertices are shared with the other shapes.
+struct Tipsify {
+    // Per vertex, sized for the whole model and reused between shapes.
+    Array<u32> live;      // Triangles not emitted yet.
+    Array<u32> adj_first; // Into adj.
+    Array<u32> adj_count; // Triangles around the vertex.
+    Array<u32> stamp;     // Cache time when the vertex was last loaded.
+    Array<u32> adj;       // Triangles around each vertex.
+    Array<u32> dead_end;  // Stack of recently emitted vertices.
+    Array<u32> candidates;
+    Array<bool> emitted;
+    Array<u32> out;
+};
+
+static fn tipsify_next_vertex(Tipsify* ts, const u32* elems, u32 elem_count, u32* cursor, u32 time, u32 cache_size) -> u32 {
+    u32 best = ~0u;
+    s32 best_priority = -1;
+    for (u32 v : ts->candidates) {
+        if (ts->live.data[v] == 0u) {
+            continue;
+        }
+        // @Note: Still in the cache after emitting its fan: prefer the oldest one, it's the next to leave.
+        s32 priority = 0;
+        if (time - ts->stamp.data[v] + 2u * ts->live.data[v] <= cache_size) {
+            priority = (s32) (time - ts->stamp.data[v]);
+        }
+        if (priority > best_priority) {
+            best_priority = priority;
+            best = v;
+        }
+    }
+    if (best != ~0u) {
+        return best;
     }
 
-    reserve(&model->vertices, (u32) attrib.vertices.size() / 3);
-    reserve(&model->elems, 1024);
+    // Dead end: go back to a recent vertex with triangles left, else the next one in the input order.
+    while (ts->dead_end.count > 0) {
+        u32 v = ts->dead_end.data[--ts->dead_end.count];
+        if (ts->live.data[v] > 0u) {
+            return v;
+        }
+    }
+    while (*cursor < elem_count) {
+        u32 v = elems[(*cursor)++];
+        if (ts->live.data[v] > 0u) {
+            return v;
+        }
+    }
+    return ~0u;
+}
+
+static fn tipsify_shape(Tipsify* ts, u32* elems, u32 elem_count, u32 cache_size) -> void {
+    u32 tri_count = elem_count / 3u;
+    if (tri_count < 2u) {
+        return;
+    }
 
-    u64 it_index = 0; for (const auto& shape: shapes)
-    {
-        u32 index_offset = count(model->elems);
-        u32 index_count = 0;
-        
-        for (const auto& idx : shape.mesh.indices)
-        {
-            IO_Model_VTX& v = append(&model->vertices);
+    // Adjacency (counting sort by vertex). Only the vertices of this shape are touched.
+    for (u32 i = 0; i < elem_count; ++i) {
+        ts->live.data[elems[i]] = 0u;
+        ts->stamp.data[elems[i]] = 0u;
+    }
+    for (u32 i = 0; i < elem_count; ++i) {
+        ++ts->live.data[elems[i]];
+    }
+    u32 offset = 0;
+    for (u32 i = 0; i < elem_count; ++i) {
+        u32 v = elems[i];
+        if (ts->stamp.data[v] == 0u) {
+            ts->stamp.data[v] = 1u; // Visited.
+            ts->adj_first.data[v] = offset;
+            ts->adj_count.data[v] = ts->live.data[v];
+            offset += ts->live.data[v];
+        }
+    }
+    reset_keeping_memory(&ts->adj);
+    reserve(&ts->adj, elem_count);
+    ts->adj.count = elem_count;
+    for (u32 i = 0; i < elem_count; ++i) {
+        ts->stamp.data[elems[i]] = 0u;
+    }
+    for (u32 t = 0; t < tri_count; ++t) {
+        for (u32 k = 0; k < 3u; ++k) {
+            u32 v = elems[t * 3u + k];
+            ts->adj.data[ts->adj_first.data[v] + ts->stamp.data[v]++] = t;
+        }
+    }
+    for (u32 i = 0; i < elem_count; ++i) {
+        ts->stamp.data[elems[i]] = 0u;
+    }
 
-            v.pos.x = attrib.vertices[3 * idx.vertex_index + 0];
-            v.pos.y = attrib.vertices[3 * idx.vertex_index + 1];
-            v.pos.z = attrib.vertices[3 * idx.vertex_index + 2];
+    reset_keeping_memory(&ts->emitted);
+    reserve(&ts->emitted, tri_count);
+    ts->emitted.count = tri_count;
+    memset(ts->emitted.data, 0, tri_count * sizeof(bool));
+    reset_keeping_memory(&ts->dead_end);
+    reset_keeping_memory(&ts->out);
+    reserve(&ts->out, elem_count);
 
-            if (idx.texcoord_index >= 0)
-            {
-                v.uv.x = attrib.texcoords[2 * idx.texcoord_index + 0];
-                v.uv.y = attrib.texcoords[2 * idx.texcoord_index + 1];
+    // @Note: Time starts past the cache size, so a stamp of 0 reads as "not in the cache".
+    u32 time = cache_size + 1u;
+    u32 cursor = 0;
+    u32 fan = elems[0];
+    while (fan != ~0u) {
+        reset_keeping_memory(&ts->candidates);
+        u32 first = ts->adj_first.data[fan];
+        u32 last = first + ts->adj_count.data[fan];
+        for (u32 j = first; j < last; ++j) {
+            u32 t = ts->adj.data[j];
+            if (ts->emitted.data[t]) {
+                continue;
             }
-            
-            v.normal.x = attrib.normals[3 * idx.normal_index + 0];
-            v.normal.y = attrib.normals[3 * idx.normal_index + 1];
-            v.normal.z = attrib.normals[3 * idx.normal_index + 2];
+            for (u32 k = 0; k < 3u; ++k) {
+                u32 v = elems[t * 3u + k];
+                append(&ts->out, v);
+                append(&ts->dead_end, v);
+                append(&ts->candidates, v);
+                --ts->live.data[v];
+                if (time - ts->stamp.data[v] > cache_size) {
+                    ts->stamp.data[v] = time;
+                    ++time;
+                }
+            }
+            ts->emitted.data[t] = true;
+        }
+        fan = tipsify_next_vertex(ts, elems, elem_count, &cursor, time, cache_size);
+    }
 
-            if (model->normals_as_colors)
-            {
-                v.color.x = v.normal.x;
-                v.color.y = v.normal.y;
-                v.color.z = v.normal.z;
-                v.color.w = 1.f;
+    checkf(ts->out.count == elem_count, "Error! Tipsify lost triangles!");
+    memcpy(elems, ts->out.data, elem_count * sizeof(u32));
+}
+
+fn io_model_optimize(IO_Model* model, u32 cache_size) -> void {
+    own_arrays(model);
+    u32 vertex_count = model->vertices.count;
+    if (vertex_count == 0u) {
+        return;
+    }
+
+    // @Note: The temporaries come from where the model arrays do, the load's scratch arena when it runs there.
+    Allocator* scratch = model->vertices.allocator;
+
+    // Vertex cache: triangle order inside each shape.
+    Tipsify ts;
+    ts.live.allocator = ts.adj_first.allocator = ts.adj_count.allocator = ts.stamp.allocator = ts.adj.allocator = scratch;
+    ts.dead_end.allocator = ts.candidates.allocator = ts.emitted.allocator = ts.out.allocator = scratch;
+    reserve(&ts.live, vertex_count);
+    reserve(&ts.adj_first, vertex_count);
+    reserve(&ts.adj_count, vertex_count);
+    reserve(&ts.stamp, vertex_count);
+    for (const IO_Model_Shape& shape : model->shapes) {
+        for (u32 i = 0; i < shape.lod_count; ++i) {
+            tipsify_shape(&ts, model->elems.data + shape.lods[i].index_offset, shape.lods[i].index_count, cache_size);
+        }
+    }
+    reset(&ts.live);
+    reset(&ts.adj_first);
+    reset(&ts.adj_count);
+    reset(&ts.stamp);
+    reset(&ts.adj);
+    reset(&ts.dead_end);
+    reset(&ts.candidates);
+    reset(&ts.emitted);
+    reset(&ts.out);
+
+    // Vertex fetch: the vertices in the order the elements first use them, so the reads walk the buffer forward.
+    // Unused vertices are dropped.
+    Array<u32> remap;
+    remap.allocator = scratch;
+    reserve(&remap, vertex_count);
+    remap.count = vertex_count;
+    memset(remap.data, 0xFF, vertex_count * sizeof(u32));
+
+    Array<IO_Model_VTX> vertices;
+    vertices.allocator = scratch;
+    reserve(&vertices, vertex_count);
+    for (u32& elem : model->elems) {
+        if (remap.data[elem] == ~0u) {
+            remap.data[elem] = vertices.count;
+            append(&vertices, model->vertices.data[elem]);
+        }
+        elem = remap.data[elem];
+    }
+
+    reset(&remap);
+    reset(&model->vertices);
+    model->vertices = vertices;
+}
+
+fn io_model_acmr(const IO_Model& model, u32 cache_size) -> f32 {
+    u32 tri_count = model.elems.count / 3u;
+    if (tri_count == 0u) {
+        return 0.0f;
+    }
+    // @Note: FIFO cache, what most of the hardware does.
+    constexpr u32 max_cache = 64u;
+    cache_size = std::min(cache_size, max_cache);
+    u32 cache[max_cache];
+    u32 cache_count = 0;
+    u32 head = 0;
+    u32 misses = 0;
+    for (u32 elem : model.elems) {
+        bool hit = false;
+        for (u32 i = 0; i < cache_count; ++i) {
+            if (cache[i] == elem) {
+                hit = true;
+                break;
             }
-            else
-            {
-               v.color = Color.White;
+        }
+        if (hit) {
+            continue;
+        }
+        ++misses;
+        if (cache_count < cache_size) {
+            cache[cache_count++] = elem;
+        } else {
+            cache[head] = elem;
+            head = (head + 1u) % cache_size;
+        }
+    }
+    return (f32) misses / (f32) tri_count;
+}
+
+// =========================================
+// @Region: LODs.
+
+// @Note: Sum of squared distances to a set of planes, as the symmetric 4x4 matrix (xx xy xz xw yy yz yw zz zw ww).
+// In doubles, the planes of a big mesh add up.
+struct Quadric {
+    f64 m[10] = {};
+};
+
+static fn quadric_add(Quadric* q, const Quadric& b) -> void {
+    for (s32 i = 0; i < 10; ++i) {
+        q->m[i] += b.m[i];
+    }
+}
+
+static fn quadric_plane(const Vec3& n, f32 d) -> Quadric {
+    f64 a = n.x, b = n.y, c = n.z, w = d;
+    return { { a * a, a * b, a * c, a * w, b * b, b * c, b * w, c * c, c * w, w * w } };
+}
+
+static fn quadric_error(const Quadric& q, const Vec3& p) -> f64 {
+    f64 x = p.x, y = p.y, z = p.z;
+    const f64* m = q.m;
+    f64 error = m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x
+              + m[4] * y * y + 2.0 * m[5] * y * z + 2.0 * m[6] * y
+              + m[7] * z * z + 2.0 * m[8] * z
+              + m[9];
+    return std::max(error, 0.0);
+}
+
+static fn triangle_normal(const Vec3& a, const Vec3& b, const Vec3& c) -> Vec3 {
+    return Vec3::cross(b - a, c - a);
+}
+
+// @Note: Half edge collapses, a vertex goes into a neighbour: no new vertices, so every level keeps indexing the
+// model vertices. Per vertex state is sized for the whole model and reused between shapes, like Tipsify.
+struct Simplifier {
+    const IO_Model_VTX* vertices = nullptr;
+    Array<u32> position;   // Per vertex: the first vertex with the same position (seams split a position in many).
+    Array<u32> remap;      // Collapsed into (itself if alive).
+    Array<u32> stamp;      // Pass when it was last touched, to keep the collapses of a pass apart.
+    Array<bool> locked;
+    Array<Quadric> quadrics;
+    Array<u32> adj_first;
+    Array<u32> adj_count;
+    Array<u32> adj;
+    Array<u32> shape_vertices;
+    Array<u64> edges;
+    Array<u32> position_uses;
+
+    struct Collapse {
+        f64 cost;
+        u32 from;
+        u32 to;
+    };
+    Array<Collapse> collapses;
+    u32 pass = 0; // Never reset, the stamps of old passes stay behind.
+};
+
+static fn simplifier_init(Simplifier* sim, const IO_Model& model) -> void {
+    u32 vertex_count = model.vertices.count;
+    sim->vertices = model.vertices.data;
+    // Where the model arrays come from, the load's scratch arena when it runs there.
+    Allocator* scratch = model.vertices.allocator;
+    sim->position.allocator = sim->remap.allocator = sim->stamp.allocator = sim->locked.allocator = scratch;
+    sim->quadrics.allocator = sim->adj_first.allocator = sim->adj_count.allocator = sim->adj.allocator = scratch;
+    sim->shape_vertices.allocator = sim->edges.allocator = sim->position_uses.allocator = scratch;
+    sim->collapses.allocator = scratch;
+    reserve(&sim->position, vertex_count);
+    reserve(&sim->remap, vertex_count);
+    reserve(&sim->stamp, vertex_count);
+    reserve(&sim->locked, vertex_count);
+    reserve(&sim->quadrics, vertex_count);
+    reserve(&sim->adj_first, vertex_count);
+    reserve(&sim->adj_count, vertex_count);
+    reserve(&sim->position_uses, vertex_count);
+    sim->position.count = sim->remap.count = sim->stamp.count = sim->locked.count = vertex_count;
+    sim->quadrics.count = sim->adj_first.count = sim->adj_count.count = sim->position_uses.count = vertex_count;
+    memset(sim->stamp.data, 0, vertex_count * sizeof(u32));
+    memset(sim->position_uses.data, 0, vertex_count * sizeof(u32));
+
+    // Positions: sorted by their bits, the first vertex of each run stands for the rest.
+    Array<u32> order;
+    order.allocator = scratch;
+    reserve(&order, vertex_count);
+    order.count = vertex_count;
+    for (u32 i = 0; i < vertex_count; ++i) {
+        order.data[i] = i;
+    }
+    const IO_Model_VTX* v = model.vertices.data;
+    std::sort(order.begin(), order.end(), [v](u32 a, u32 b) {
+        s32 diff = memcmp(&v[a].pos, &v[b].pos, sizeof(Vec3));
+        return diff != 0 ? diff < 0 : a < b;
+    });
+    for (u32 i = 0; i < vertex_count; ++i) {
+        bool same = i > 0 && memcmp(&v[order.data[i]].pos, &v[order.data[i - 1]].pos, sizeof(Vec3)) == 0;
+        sim->position.data[order.data[i]] = same ? sim->position.data[order.data[i - 1]] : order.data[i];
+    }
+    reset(&order);
+}
+
+static fn simplifier_done(Simplifier* sim) -> void {
+    reset(&sim->position);
+    reset(&sim->remap);
+    reset(&sim->stamp);
+    reset(&sim->locked);
+    reset(&sim->quadrics);
+    reset(&sim->adj_first);
+    reset(&sim->adj_count);
+    reset(&sim->adj);
+    reset(&sim->shape_vertices);
+    reset(&sim->edges);
+    reset(&sim->position_uses);
+    reset(&sim->collapses);
+}
+
+// @Note: Quadrics and locks from the full mesh of a shape. Locked: the positions with more than one vertex (uv or
+// normal seams) and the ones on an edge without exactly two triangles (borders, non manifold).
+static fn simplifier_begin_shape(Simplifier* sim, const u32* elems, u32 elem_count) -> void {
+    reset_keeping_memory(&sim->shape_vertices);
+    for (u32 i = 0; i < elem_count; ++i) {
+        u32 v = elems[i];
+        if (sim->stamp.data[v] != ~0u) {
+            sim->stamp.data[v] = ~0u;
+            append(&sim->shape_vertices, v);
+        }
+    }
+    for (u32 v : sim->shape_vertices) {
+        sim->stamp.data[v] = 0u;
+        sim->remap.data[v] = v;
+        sim->locked.data[v] = false;
+        sim->quadrics.data[v] = {};
+        sim->position_uses.data[sim->position.data[v]] = 0u;
+    }
+    for (u32 v : sim->shape_vertices) {
+        ++sim->position_uses.data[sim->position.data[v]];
+    }
+
+    reset_keeping_memory(&sim->edges);
+    reserve(&sim->edges, elem_count);
+    for (u32 t = 0; t + 2u < elem_count; t += 3u) {
+        for (u32 e = 0; e < 3u; ++e) {
+            u32 a = sim->position.data[elems[t + e]];
+            u32 b = sim->position.data[elems[t + (e + 1u) % 3u]];
+            append(&sim->edges, ((u64) std::min(a, b) << 32) | std::max(a, b));
+        }
+
+        const Vec3& p0 = sim->vertices[elems[t + 0]].pos;
+        const Vec3& p1 = sim->vertices[elems[t + 1]].pos;
+        const Vec3& p2 = sim->vertices[elems[t + 2]].pos;
+        Vec3 n = triangle_normal(p0, p1, p2);
+        f32 length = n.lenght();
+        if (length <= 0.0f) {
+            continue;
+        }
+        n /= length;
+        Quadric plane = quadric_plane(n, -Vec3::dot(n, p0));
+        for (u32 e = 0; e < 3u; ++e) {
+            quadric_add(&sim->quadrics.data[elems[t + e]], plane);
+        }
+    }
+
+    // @Note: Locks by position first (position_uses is reused as the flag), then every vertex reads its position.
+    std::sort(sim->edges.begin(), sim->edges.end());
+    for (u32 i = 0; i < sim->edges.count;) {
+        u32 run = 1;
+        while (i + run < sim->edges.count && sim->edges.data[i + run] == sim->edges.data[i]) {
+            ++run;
+        }
+        if (run != 2u) {
+            sim->position_uses.data[(u32) (sim->edges.data[i] >> 32)] = ~0u;
+            sim->position_uses.data[(u32) sim->edges.data[i]] = ~0u;
+        }
+        i += run;
+    }
+    for (u32 v : sim->shape_vertices) {
+        sim->locked.data[v] = sim->position_uses.data[sim->position.data[v]] != 1u;
+    }
+}
+
+// @Note: Would moving `from` onto `to` flip (or flatten) any of its triangles that stay?
+static fn collapse_flips(const Simplifier& sim, const u32* tris, u32 from, u32 to) -> bool {
+    const Vec3& target = sim.vertices[to].pos;
+    for (u32 i = 0; i < sim.adj_count.data[from]; ++i) {
+        const u32* tri = tris + sim.adj.data[sim.adj_first.data[from] + i] * 3u;
+        if (tri[0] == to || tri[1] == to || tri[2] == to) {
+            continue; // It goes away.
+        }
+        Vec3 p[3];
+        Vec3 q[3];
+        for (u32 k = 0; k < 3u; ++k) {
+            p[k] = sim.vertices[tri[k]].pos;
+            q[k] = tri[k] == from ? target : p[k];
+        }
+        Vec3 before = triangle_normal(p[0], p[1], p[2]);
+        Vec3 after = triangle_normal(q[0], q[1], q[2]);
+        if (Vec3::dot(before, after) <= 0.25f * before.lenght() * after.lenght()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// @Note: Collapses the cheapest edges of tris until there are at most target triangles (or nothing can go). Each pass
+// sorts the candidates and takes the ones whose neighbourhoods don't overlap. Returns the largest error taken.
+static fn simplify(Simplifier* sim, Array<u32>* tris, u32 target) -> f64 {
+    f64 max_error = 0.0;
+    while (tris->count / 3u > target) {
+        u32 pass = ++sim->pass;
+        u32 tri_count = tris->count / 3u;
+
+        // Triangles around each vertex (counting sort).
+        for (u32 v : sim->shape_vertices) {
+            sim->adj_count.data[v] = 0u;
+        }
+        for (u32 i = 0; i < tris->count; ++i) {
+            ++sim->adj_count.data[tris->data[i]];
+        }
+        u32 offset = 0;
+        for (u32 v : sim->shape_vertices) {
+            sim->adj_first.data[v] = offset;
+            offset += sim->adj_count.data[v];
+            sim->adj_count.data[v] = 0u;
+        }
+        reset_keeping_memory(&sim->adj);
+        reserve(&sim->adj, tris->count);
+        sim->adj.count = tris->count;
+        for (u32 i = 0; i < tris->count; ++i) {
+            u32 v = tris->data[i];
+            sim->adj.data[sim->adj_first.data[v] + sim->adj_count.data[v]++] = i / 3u;
+        }
+
+        // @Note: One candidate per vertex, its cheapest edge. The error is linear in the quadrics, no need to add them.
+        reset_keeping_memory(&sim->collapses);
+        reserve(&sim->collapses, sim->shape_vertices.count);
+        for (u32 from : sim->shape_vertices) {
+            if (sim->locked.data[from] || sim->adj_count.data[from] == 0u) {
+                continue;
             }
-            
-            append(&model->elems, count(model->elems));
-            ++index_count;
+            Simplifier::Collapse best = { DBL_MAX, from, from };
+            for (u32 i = 0; i < sim->adj_count.data[from]; ++i) {
+                const u32* tri = tris->data + sim->adj.data[sim->adj_first.data[from] + i] * 3u;
+                for (u32 k = 0; k < 3u; ++k) {
+                    u32 to = tri[k];
+                    if (to == from) {
+                        continue;
+                    }
+                    const Vec3& p = sim->vertices[to].pos;
+                    f64 cost = quadric_error(sim->quadrics.data[from], p) + quadric_error(sim->quadrics.data[to], p);
+                    if (cost < best.cost) {
+                        best = { cost, from, to };
+                    }
+                }
+            }
+            append(&sim->collapses, best);
         }
+        std::sort(sim->collapses.begin(), sim->collapses.end(), [](const Simplifier::Collapse& a, const Simplifier::Collapse& b) {
+            return a.cost < b.cost;
+        });
 
-        IO_Model_Shape& s = append(&model->shapes);
-        s.index_offset = index_offset;
-        s.index_count = index_count;
-        s.material_index = shape.mesh.material_ids.empty() ? 0u : static_cast<u32>(shape.mesh.material_ids[0]);
-        
-        if (it_index < materials.size())
-        {
-            s.name = materials[it_index].name;
-            s.textures.ambient = materials[it_index].ambient_texname;
-            s.textures.diffuse = materials[it_index].diffuse_texname;
+        u32 removed = 0;
+        u32 collapsed = 0;
+        for (const Simplifier::Collapse& c : sim->collapses) {
+            if (tri_count - removed <= target) {
+                break;
+            }
+            if (sim->stamp.data[c.from] == pass || sim->stamp.data[c.to] == pass || collapse_flips(*sim, tris->data, c.from, c.to)) {
+                continue;
+            }
+            // The whole fan of `from` waits for the next pass, its triangles are about to change.
+            for (u32 i = 0; i < sim->adj_count.data[c.from]; ++i) {
+                const u32* tri = tris->data + sim->adj.data[sim->adj_first.data[c.from] + i] * 3u;
+                removed += tri[0] == c.to || tri[1] == c.to || tri[2] == c.to;
+                sim->stamp.data[tri[0]] = sim->stamp.data[tri[1]] = sim->stamp.data[tri[2]] = pass;
+            }
+            sim->remap.data[c.from] = c.to;
+            quadric_add(&sim->quadrics.data[c.to], sim->quadrics.data[c.from]);
+            max_error = std::max(max_error, c.cost);
+            ++collapsed;
+        }
+        if (collapsed == 0u) {
+            break;
         }
 
-        ++it_index;
+        u32 kept = 0;
+        for (u32 t = 0; t < tris->count; t += 3u) {
+            u32 a = sim->remap.data[tris->data[t + 0]];
+            u32 b = sim->remap.data[tris->data[t + 1]];
+            u32 c = sim->remap.data[tris->data[t + 2]];
+            if (a != b && b != c && c != a) {
+                tris->data[kept++] = a;
+                tris->data[kept++] = b;
+                tris->data[kept++] = c;
+            }
+        }
+        tris->count = kept;
     }
-    
-    return true;
-}
\ No newline at end of file
+    return max_error;
+}
+
+fn io_model_build_lods(IO_Model* model, u32 lod_count, f32 ratio) -> void {
+    own_arrays(model);
+    lod_count = std::min(lod_count, io_model_max_lods);
+    if (lod_count < 2u || model->vertices.count == 0u) {
+        return;
+    }
+
+    Simplifier sim;
+    simplifier_init(&sim, *model);
+    Array<u32> tris;
+    tris.allocator = model->elems.allocator;
+    for (IO_Model_Shape& shape : model->shapes) {
+        shape.lods[0] = { shape.index_offset, shape.index_count, 0.0f };
+        shape.lod_count = 1;
+
+        const u32* elems = model->elems.data + shape.index_offset;
+        simplifier_begin_shape(&sim, elems, shape.index_count);
+        reset_keeping_memory(&tris);
+        reserve(&tris, shape.index_count);
+        tris.count = shape.index_count;
+        memcpy(tris.data, elems, shape.index_count * sizeof(u32));
+
+        f64 error = 0.0;
+        while (shape.lod_count < lod_count) {
+            u32 prev_tris = tris.count / 3u;
+            u32 target = (u32) ((f32) prev_tris * ratio);
+            error = std::max(error, simplify(&sim, &tris, target));
+            // @Note: Not worth a level if it barely lost anything, the locked parts are all that's left. At least one
+            // triangle has to go, an eighth of a tiny shape rounds down to none.
+            u32 lost = prev_tris - std::min(tris.count / 3u, prev_tris);
+            if (tris.count == 0u || lost < std::max(1u, prev_tris / 8u)) {
+                break;
+            }
+            IO_Model_Lod& lod = shape.lods[shape.lod_count++];
+            lod.index_offset = model->elems.count;
+            lod.index_count = tris.count;
+            lod.error = (f32) sqrt(error);
+            // Doubles, so the chain of levels doesn't copy elems once per level.
+            try_grow(&model->elems, tris.count);
+            memcpy(model->elems.data + model->elems.count, tris.data, tris.count * sizeof(u32));
+            model->elems.count += tris.count;
+        }
+    }
+    reset(&tris);
+    simplifier_done(&sim);
+}
+
+fn io_model_select_lod(const IO_Model_Shape& shape, f32 distance, f32 fov_y, f32 screen_height, f32 max_pixel_error) -> u32 {
+    if (distance <= 0.0f) {
+        return 0;
+    }
+    f32 pixels_per_unit = screen_height / (2.0f * distance * tanf(fov_y * 0.5f));
+    u32 lod = 0;
+    while (lod + 1u < shape.lod_count && shape.lods[lod + 1u].error * pixels_per_unit <= max_pixel_error) {
+        ++lod;
+    }
+    return lod;
+}
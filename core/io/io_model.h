@@ -1,10 +1,7 @@
 #pragma once
 
-// @Pending:
-
-// Este modelo no es el que realmente querríamos para una app real.
-
-// (para desarrollo mirar io_image.h).
+#include "os_core.h"
+#include "io_storage.h"
 
 struct IO_Model_VTX {
     Vec3 pos;
@@ -13,6 +10,32 @@ struct IO_Model_VTX {
     Vec4 color;
 };
 
+// @Note: What the gpu gets, 24 bytes. Normals as snorm 10_10_10_2, uvs as halfs (fine for tiled uvs in
+// a few thousand repeats), colors as unorm bytes. Same attribute order as IO_Model_VTX.
+struct IO_Model_Packed_VTX {
+    Vec3  pos;
+    Half2 uv;
+    u32   normal; // SNorm1010102.
+    u32   color;  // UNorm8x4.
+};
+
+inline constexpr Data_Type io_model_packed_attrs[] = {
+    Data_Type::Float3,       // Position.
+    Data_Type::Half2,        // UVs.
+    Data_Type::SNorm1010102, // Normal.
+    Data_Type::UNorm8x4,     // Color.
+};
+
+// @Note: A range of elems drawing the shape at some detail. error is about how far (object space) the surface moved
+// from the full mesh, it grows with every level.
+struct IO_Model_Lod {
+    u32 index_offset = 0;
+    u32 index_count = 0;
+    f32 error = 0.0f;
+};
+
+inline constexpr u32 io_model_max_lods = 6;
+
 struct IO_Model_Shape {
     struct {
         std::string ambient;
@@ -23,15 +46,47 @@ struct IO_Model_Shape {
     u32 index_offset = 0;
     u32 index_count = 0;
     u32 material_index = 0;
+    // @Note: lods[0] is the full mesh (index_offset and index_count), the rest go after every shape in elems.
+    IO_Model_Lod lods[io_model_max_lods];
+    u32 lod_count = 1;
 };
 
+// @Note: Once loaded, vertices and elems are views (cap 0) of two io storage blocks (see io_storage.h), or of the
+// mapping for a cooked file (read only). They can't grow: io_model_optimize and io_model_build_lods copy them back
+// to the heap first (io_model_load builds them in a scratch arena instead). Free the model with io_model_free either way.
 struct IO_Model {
     bool normals_as_colors = false;
+    bool optimize = true; // Runs io_model_optimize after loading.
+    bool cook = true;     // Writes the cooked file after parsing the obj, the next loads map that instead.
+    u32 lod_count = 4;    // Levels per shape built after loading (see io_model_build_lods), 1 is just the full mesh.
     std::string name;
     std::string dirpath;
     Array<IO_Model_VTX> vertices;
     Array<u32> elems;
     Array<IO_Model_Shape> shapes;
+    Mapped_File cooked;
+    IO_Block vertex_block;
+    IO_Block elem_block;
 };
 
-fn io_model_load(std::string_view filename, IO_Model* model) -> bool;
\ No newline at end of file
+// @Note: Maps filename + ".cooked" if it's there and up to date (same obj write time and load options), else parses
+// the obj. Cooked files only go into empty models, a model with data gets the obj appended.
+fn io_model_load(std::string_view filename, IO_Model* model) -> bool;
+fn io_model_free(IO_Model* model) -> void;
+// @Note: Writes the model as cooked for source_filename (the obj it came from): a header, then the vertex, index,
+// shape and string sections, 16 byte aligned. io_model_load does it the first time, this is for offline cooking.
+fn io_model_cook(const IO_Model& model, std::string_view source_filename) -> bool;
+fn io_model_cooked_path(std::string_view filename) -> std::string;
+// @Note: Reorders the triangles of each shape for the post-transform vertex cache (Tipsify), then the vertices by first
+// use, so the gpu fetches them in order. The shapes keep their element ranges.
+fn io_model_optimize(IO_Model* model, u32 cache_size = 16) -> void;
+// @Note: Average cache miss ratio, vertices transformed per triangle with a FIFO cache (0.5 is the ideal, 3 no reuse).
+fn io_model_acmr(const IO_Model& model, u32 cache_size = 16) -> f32;
+// @Note: Quadric error simplification (edge collapses into existing vertices, so the LODs share the vertex buffer).
+// Each level aims at ratio times the triangles of the previous one, the chain stops early when a shape can't lose
+// more. Borders and uv/normal seams don't move. Run it before io_model_optimize, it appends to elems.
+fn io_model_build_lods(IO_Model* model, u32 lod_count, f32 ratio = 0.5f) -> void;
+// @Note: The coarsest level whose error covers at most max_pixel_error pixels on screen. distance from the camera in
+// object space units (divide by the scale of the object), fov_y in radians.
+fn io_model_select_lod(const IO_Model_Shape& shape, f32 distance, f32 fov_y, f32 screen_height, f32 max_pixel_error = 1.0f) -> u32;
+fn io_model_pack(const IO_Model& model, Array<IO_Model_Packed_VTX>* vertices) -> void;
\ No newline at end of file
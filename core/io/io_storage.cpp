@@ -0,0 +1,172 @@
+#include "io_storage.h"
+#include <mutex>
+
+static constexpr u64 g_page_sizes[] = { 1ull << 20, 8ull << 20, 64ull << 20 };
+static constexpr u64 g_max_block_sizes[] = { 64ull << 10, 1ull << 20, 16ull << 20 };
+static constexpr s32 g_kept_empty_pages = 2; // Per class, the rest go back to the OS when they empty.
+
+struct IO_Page {
+    u8* data = nullptr; // Null if the slot is free.
+    u64 size = 0;
+    u64 used = 0;
+    u64 live = 0;
+    s32 blocks = 0;
+    IO_Page_Class kind = IO_Page_Class::Small;
+};
+
+struct {
+    Array<IO_Page> pages; // Slots, the blocks keep their index.
+    u64 page_allocs = 0;
+    u64 page_releases = 0;
+    std::mutex mutex;
+} g_storage;
+
+static fn page_class(u64 size) -> IO_Page_Class {
+    for (s32 i = 0; i < (s32) IO_Page_Class::Huge; ++i) {
+        if (size <= g_max_block_sizes[i]) {
+            return (IO_Page_Class) i;
+        }
+    }
+    return IO_Page_Class::Huge;
+}
+
+static fn page_new(IO_Page_Class kind, u64 size) -> u32 {
+    u32 index = g_storage.pages.count;
+    for (u32 i = 0; i < g_storage.pages.count; ++i) {
+        if (!g_storage.pages.data[i].data) {
+            index = i;
+            break;
+        }
+    }
+    if (index == g_storage.pages.count) {
+        append(&g_storage.pages);
+    }
+
+    IO_Page& page = g_storage.pages.data[index];
+    page = {};
+    page.data = new u8[size];
+    page.size = size;
+    page.kind = kind;
+    ++g_storage.page_allocs;
+    return index;
+}
+
+static fn page_release(IO_Page* page) -> void {
+    delete[] page->data;
+    *page = {};
+    ++g_storage.page_releases;
+}
+
+// @Note: Where a block of size (aligned) would start in the page, or ~0 if it doesn't fit.
+static fn page_fit(const IO_Page& page, u64 size, u64 align) -> u64 {
+    u64 start = (u64) (uintptr_t) page.data;
+    u64 offset = ((start + page.used + align - 1u) & ~(align - 1u)) - start;
+    return offset + size <= page.size ? offset : ~0ull;
+}
+
+fn io_storage_alloc(u64 size, u64 align) -> IO_Block {
+    IO_Block block;
+    if (size == 0) {
+        return block;
+    }
+    checkf(align > 0 && (align & (align - 1u)) == 0, "Error! The alignment must be a power of two!");
+
+    std::lock_guard<std::mutex> lock(g_storage.mutex);
+
+    // @Note: align - 1 is the worst padding, so the block always fits a fresh page of its class.
+    IO_Page_Class kind = page_class(size + align - 1u);
+    u32 index = ~0u;
+    u64 offset = 0;
+    if (kind != IO_Page_Class::Huge) {
+        for (u32 i = 0; i < g_storage.pages.count; ++i) {
+            const IO_Page& page = g_storage.pages.data[i];
+            if (page.data && page.kind == kind) {
+                offset = page_fit(page, size, align);
+                if (offset != ~0ull) {
+                    index = i;
+                    break;
+                }
+            }
+        }
+    }
+    if (index == ~0u) {
+        u64 page_size = kind == IO_Page_Class::Huge ? size + align - 1u : g_page_sizes[(s32) kind];
+        index = page_new(kind, page_size);
+        offset = page_fit(g_storage.pages.data[index], size, align);
+    }
+
+    IO_Page& page = g_storage.pages.data[index];
+    page.used = offset + size;
+    page.live += size;
+    ++page.blocks;
+
+    block.data = page.data + offset;
+    block.size = size;
+    block.page = index;
+    return block;
+}
+
+fn io_storage_free(IO_Block* block) -> void {
+    if (!block->data) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(g_storage.mutex);
+    checkf(block->page < g_storage.pages.count && g_storage.pages.data[block->page].data, "Error! This block is not from the storage!");
+
+    IO_Page& page = g_storage.pages.data[block->page];
+    page.live -= block->size;
+    --page.blocks;
+    *block = {};
+    if (page.blocks > 0) {
+        return;
+    }
+
+    // Empty: it starts over, or goes back to the OS if there are enough empty ones already.
+    page.used = 0;
+    page.live = 0;
+    s32 empty_pages = 0;
+    for (const IO_Page& it : g_storage.pages) {
+        empty_pages += it.data && it.kind == page.kind && it.blocks == 0;
+    }
+    if (page.kind == IO_Page_Class::Huge || empty_pages > g_kept_empty_pages) {
+        page_release(&page);
+    }
+}
+
+fn io_storage_trim() -> void {
+    std::lock_guard<std::mutex> lock(g_storage.mutex);
+    for (IO_Page& page : g_storage.pages) {
+        if (page.data && page.blocks == 0) {
+            page_release(&page);
+        }
+    }
+}
+
+fn io_storage_stats() -> IO_Storage_Stats {
+    std::lock_guard<std::mutex> lock(g_storage.mutex);
+    IO_Storage_Stats stats;
+    for (const IO_Page& page : g_storage.pages) {
+        if (!page.data) {
+            continue;
+        }
+        IO_Storage_Stats::Class& it = stats.classes[(s32) page.kind];
+        ++it.pages;
+        it.empty_pages += page.blocks == 0;
+        it.reserved += page.size;
+        it.used += page.used;
+        it.live += page.live;
+        it.blocks += page.blocks;
+    }
+    stats.page_allocs = g_storage.page_allocs;
+    stats.page_releases = g_storage.page_releases;
+    return stats;
+}
+
+fn io_storage_fragmentation(const IO_Storage_Stats::Class& stats) -> f32 {
+    return stats.used > 0 ? (f32) (stats.used - stats.live) / (f32) stats.used : 0.0f;
+}
+
+fn io_storage_occupancy(const IO_Storage_Stats::Class& stats) -> f32 {
+    return stats.reserved > 0 ? (f32) stats.live / (f32) stats.reserved : 0.0f;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+// @Note: Where the pixels and the vertices of the loaded assets live. Memory comes in pages of three sizes, every
+// allocation bumps forward inside a page of its class and freeing only counts it out: a page goes back to the pool
+// when all its blocks are freed. So loading and unloading levels reuses the same few big pages instead of hitting
+// the heap per asset. Anything bigger than a large block gets a page of its own (Huge), released with it.
+// Safe to use from the job pool (the image decodes run there).
+
+enum class IO_Page_Class : u8 {
+    Small,  //  1 MB pages, blocks up to 64 KB.
+    Medium, //  8 MB pages, blocks up to 1 MB.
+    Large,  // 64 MB pages, blocks up to 16 MB.
+    Huge,   // One page per block.
+    Count,
+};
+
+struct IO_Block {
+    u8* data = nullptr;
+    u64 size = 0;
+    u32 page = ~0u;
+};
+
+struct IO_Storage_Stats {
+    struct Class {
+        s32 pages = 0;
+        s32 empty_pages = 0; // Kept for the next loads (see io_storage_trim).
+        u64 reserved = 0;    // Bytes of every page.
+        u64 used = 0;        // Bytes bumped, freed blocks still count until their page empties.
+        u64 live = 0;        // Bytes of the blocks still allocated.
+        s32 blocks = 0;
+    };
+    Class classes[(s32) IO_Page_Class::Count];
+    u64 page_allocs = 0;
+    u64 page_releases = 0;
+};
+
+fn io_storage_alloc(u64 size, u64 align = 16) -> IO_Block;
+fn io_storage_free(IO_Block* block) -> void;
+// @Note: Gives the empty pages back to the OS (a couple per class are kept otherwise).
+fn io_storage_trim() -> void;
+fn io_storage_stats() -> IO_Storage_Stats;
+// @Note: The part of the bumped bytes held by freed blocks (and padding) of pages still in use: (used - live) / used.
+fn io_storage_fragmentation(const IO_Storage_Stats::Class& stats) -> f32;
+// @Note: Of the pages, the part taken by live blocks: live / reserved.
+fn io_storage_occupancy(const IO_Storage_Stats::Class& stats) -> f32;
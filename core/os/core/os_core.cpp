@@ -15,9 +15,15 @@
 #else
 #include <limits.h>
 #include <unistd.h>    // write, close.
+#include <sys/stat.h>  // mkdir, fstat.
+#include <sys/mman.h>  // mmap.
+#include <fcntl.h>     // open.
+#include <dirent.h>    // opendir.
 #define PATH_SEPARATOR '/'
 #endif
 
+#include <errno.h>
+
 fn get_absolute_path(std::string_view filename) -> std::string {
 #ifdef GAME_WIN
     char buffer[MAX_PATH];
@@ -117,6 +123,82 @@ fn os_read_entire_file(std::string_view filename) -> std::string {
     return buffer;
 }
 
+fn os_map_file(std::string_view filename) -> Mapped_File {
+    Mapped_File mapped;
+    std::string path(filename);
+#ifdef GAME_WIN
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return mapped;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return mapped;
+    }
+    // @Note: The view keeps the mapping (and the file) alive, so the handles can go now.
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        return mapped;
+    }
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data) {
+        return mapped;
+    }
+    mapped.data = (const char*) data;
+    mapped.size = (u64) size.QuadPart;
+#else
+    s32 fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return mapped;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        close(fd);
+        return mapped;
+    }
+    void* data = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return mapped;
+    }
+    mapped.data = (const char*) data;
+    mapped.size = (u64) info.st_size;
+#endif
+    return mapped;
+}
+
+fn os_unmap_file(Mapped_File* file) -> void {
+    if (file->data) {
+#ifdef GAME_WIN
+        UnmapViewOfFile(file->data);
+#else
+        munmap((void*) file->data, (size_t) file->size);
+#endif
+    }
+    *file = {};
+}
+
+fn os_get_file_time(std::string_view filename) -> u64 {
+    std::string path(filename);
+#ifdef GAME_WIN
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path.c_str(), GetFileExInfoStandard, &data)) {
+        return 0;
+    }
+    return ((u64) data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return 0;
+    }
+    return (u64) info.st_mtim.tv_sec * 1000000000ull + (u64) info.st_mtim.tv_nsec;
+#endif
+}
+
 fn os_write_entire_file(std::string_view filename, std::string_view content) -> bool {
     FILE* file = fopen(filename.data(), "wb");
     if (!file) {
@@ -129,6 +211,62 @@ fn os_write_entire_file(std::string_view filename, std::string_view content) ->
     return written == content.size();
 }
 
+fn os_make_dir(std::string_view path) -> bool {
+    std::string dir(path);
+#ifdef GAME_WIN
+    s32 result = _mkdir(dir.c_str());
+#else
+    s32 result = mkdir(dir.c_str(), 0755);
+#endif
+    return result == 0 || errno == EEXIST;
+}
+
+fn os_walk_dir(std::string_view dir, Walk_Fn visit, void* user) -> void {
+    std::string root(dir);
+#ifdef GAME_WIN
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA((root + "\\*").c_str(), &data);
+    if (find == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        std::string_view name = data.cFileName;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = root + PATH_SEPARATOR + std::string(name);
+        if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            os_walk_dir(path, visit, user);
+        } else {
+            visit(user, path);
+        }
+    } while (FindNextFileA(find, &data));
+    FindClose(find);
+#else
+    DIR* handle = opendir(root.c_str());
+    if (!handle) {
+        return;
+    }
+    while (dirent* entry = readdir(handle)) {
+        std::string_view name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = root + PATH_SEPARATOR + std::string(name);
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            continue;
+        }
+        if (S_ISDIR(info.st_mode)) {
+            os_walk_dir(path, visit, user);
+        } else {
+            visit(user, path);
+        }
+    }
+    closedir(handle);
+#endif
+}
+
 fn os_trim(std::string text) -> std::string {
     std::string s = text;
     // left Global::trim
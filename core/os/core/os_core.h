@@ -14,9 +14,34 @@ fn get_extension(std::string_view path) -> std::string;
 fn get_path_info(std::string_view filename) -> Path_Info;
 
 fn os_read_entire_file(std::string_view filename) -> std::string;
+
+// @Note: Read only view of a whole file, the OS pages it in on demand. data is null if it could not be mapped (or it's empty).
+struct Mapped_File {
+    const char* data = nullptr;
+    u64 size = 0;
+};
+
+fn os_map_file(std::string_view filename) -> Mapped_File;
+fn os_unmap_file(Mapped_File* file) -> void;
+// @Note: Last write time in an OS specific unit, only good to compare with another one. 0 if the file doesn't exist.
+fn os_get_file_time(std::string_view filename) -> u64;
 fn os_write_entire_file(std::string_view filename, std::string_view content) -> bool;
+// @Note: True if the dir exists after the call (it may already exist).
+fn os_make_dir(std::string_view path) -> bool;
+// @Note: Calls visit(user, path) for every file under dir, subdirs included. path is dir + separator + name.
+using Walk_Fn = void (*)(void* user, std::string_view path);
+fn os_walk_dir(std::string_view dir, Walk_Fn visit, void* user) -> void;
 fn os_trim(std::string text) -> std::string;
 
+// @Note: Ex: os_walk_dir("sprites", [&](std::string_view path) { ... });
+template<typename F>
+fn os_walk_dir(std::string_view dir, const F& f) -> void {
+    Walk_Fn visit = [](void* user, std::string_view path) {
+        (*(const F*) user)(path);
+    };
+    os_walk_dir(dir, visit, (void*) &f);
+}
+
 // @Note: This is relative to the exe path. Ex: "\\..\\..\\assets" would set the wdir two folders up the exe, inside the assets dir.
 fn os_set_working_dir(const std::string& path) -> void;
 fn os_get_time() -> f64;
\ No newline at end of file
@@ -46,8 +46,35 @@
     DO(PFNGLCREATETEXTURESPROC,            glCreateTextures)            \
     DO(PFNGLTEXTURESTORAGE2DPROC,          glTextureStorage2D)          \
     DO(PFNGLTEXTURESUBIMAGE2DPROC,         glTextureSubImage2D)         \
+    DO(PFNGLCOMPRESSEDTEXTURESUBIMAGE2DPROC, glCompressedTextureSubImage2D) \
+    DO(PFNGLTEXTURESTORAGE3DPROC,          glTextureStorage3D)          \
+    DO(PFNGLTEXTURESUBIMAGE3DPROC,         glTextureSubImage3D)         \
     DO(PFNGLTEXTUREPARAMETERIPROC,         glTextureParameteri)         \
     DO(PFNGLBINDTEXTUREUNITPROC,           glBindTextureUnit)           \
+    DO(PFNGLDRAWELEMENTSINSTANCEDPROC,     glDrawElementsInstanced)     \
+    DO(PFNGLNAMEDBUFFERSTORAGEPROC,        glNamedBufferStorage)        \
+    DO(PFNGLMAPNAMEDBUFFERRANGEPROC,       glMapNamedBufferRange)       \
+    DO(PFNGLUNMAPNAMEDBUFFERPROC,          glUnmapNamedBuffer)          \
+    DO(PFNGLBINDBUFFERRANGEPROC,           glBindBufferRange)           \
+    DO(PFNGLFENCESYNCPROC,                 glFenceSync)                 \
+    DO(PFNGLCLIENTWAITSYNCPROC,            glClientWaitSync)            \
+    DO(PFNGLDELETESYNCPROC,                glDeleteSync)                \
+    DO(PFNGLGETACTIVEUNIFORMPROC,          glGetActiveUniform)          \
+    DO(PFNGLGETACTIVEUNIFORMBLOCKIVPROC,   glGetActiveUniformBlockiv)   \
+    DO(PFNGLGETACTIVEUNIFORMBLOCKNAMEPROC, glGetActiveUniformBlockName) \
+    DO(PFNGLPROGRAMUNIFORM1IVPROC,         glProgramUniform1iv)         \
+    DO(PFNGLPROGRAMUNIFORM2IVPROC,         glProgramUniform2iv)         \
+    DO(PFNGLPROGRAMUNIFORM3IVPROC,         glProgramUniform3iv)         \
+    DO(PFNGLPROGRAMUNIFORM4IVPROC,         glProgramUniform4iv)         \
+    DO(PFNGLPROGRAMUNIFORM1FVPROC,         glProgramUniform1fv)         \
+    DO(PFNGLPROGRAMUNIFORM2FVPROC,         glProgramUniform2fv)         \
+    DO(PFNGLPROGRAMUNIFORM3FVPROC,         glProgramUniform3fv)         \
+    DO(PFNGLPROGRAMUNIFORM4FVPROC,         glProgramUniform4fv)         \
+    DO(PFNGLPROGRAMUNIFORMMATRIX3FVPROC,   glProgramUniformMatrix3fv)   \
+    DO(PFNGLPROGRAMUNIFORMMATRIX4FVPROC,   glProgramUniformMatrix4fv)   \
+    DO(PFNGLPROGRAMPARAMETERIPROC,         glProgramParameteri)         \
+    DO(PFNGLGETPROGRAMBINARYPROC,          glGetProgramBinary)          \
+    DO(PFNGLPROGRAMBINARYPROC,             glProgramBinary)             \
 
 // @Note: We define GL_PROCS_NO_EXTERN just in one translation unit (gl_context.cpp)
 // So that the compiler knows that which is the impl file, and which ones are just declaration files.
@@ -96,16 +123,17 @@ inline fn os_compile_gl_shader_with_prefix(std::string_view source, std::string_
     return shader;
 }
 
-inline fn os_create_gl_program(std::string_view source) -> GLuint {
+// @Note: defines is pasted right after the #version line of both stages. Ex: "#define INSTANCED \n".
+inline fn os_create_gl_program(std::string_view source, std::string_view defines = {}) -> GLuint {
     if (source.empty())
     {
         logf("Error! The shader source cannot be empty!");
         return 0u;
     }
     
-    static  constexpr const char* vert_prefix =
-        "#version 460 core \n"
-        "#define VERTEX_SHADER \n";
+    std::string vert_prefix = "#version 460 core \n";
+    vert_prefix += defines;
+    vert_prefix += "#define VERTEX_SHADER \n";
     
     GLuint vert = os_compile_gl_shader_with_prefix(source, vert_prefix, GL_VERTEX_SHADER);
 
@@ -115,9 +143,9 @@ inline fn os_create_gl_program(std::string_view source) -> GLuint {
         return 0u;
     }
 
-    static  constexpr const char* frag_prefix =
-        "#version 460 core \n"
-        "#define FRAGMENT_SHADER \n";
+    std::string frag_prefix = "#version 460 core \n";
+    frag_prefix += defines;
+    frag_prefix += "#define FRAGMENT_SHADER \n";
 
     GLuint frag = os_compile_gl_shader_with_prefix(source, frag_prefix, GL_FRAGMENT_SHADER);
 
@@ -134,6 +162,9 @@ inline fn os_create_gl_program(std::string_view source) -> GLuint {
     glAttachShader(prog, vert);
     glAttachShader(prog, frag);
 
+    // @Note: So we can store it in the program binary cache.
+    glProgramParameteri(prog, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
     glLinkProgram(prog);
 
     glDeleteShader(vert);
@@ -155,6 +186,57 @@ inline fn os_create_gl_program(std::string_view source) -> GLuint {
     return prog;
 }
 
+// @Note: Identifies the driver, a program binary is only valid for the one that made it.
+inline fn os_gl_driver_string() -> std::string {
+    std::string driver;
+    for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+        const char* str = (const char*) glGetString(name);
+        driver += str ? str : "";
+        driver += '|';
+    }
+    return driver;
+}
+
+// @Note: Program binary blob layout: | binary format (u32) | binary |
+inline fn os_get_gl_program_binary(GLuint prog, std::string* blob) -> bool {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    GLint length = 0;
+    glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (formats == 0 || length <= 0) {
+        return false;
+    }
+
+    blob->resize(sizeof(u32) + length);
+    GLenum format = 0;
+    glGetProgramBinary(prog, length, &length, &format, &(*blob)[sizeof(u32)]);
+    u32 format_u32 = format;
+    memcpy(&(*blob)[0], &format_u32, sizeof(u32));
+    blob->resize(sizeof(u32) + length);
+    return true;
+}
+
+// @Note: Returns 0 if the driver rejects the binary (other driver, other version...).
+inline fn os_create_gl_program_from_binary(std::string_view blob) -> GLuint {
+    if (blob.size() <= sizeof(u32)) {
+        return 0u;
+    }
+
+    u32 format;
+    memcpy(&format, blob.data(), sizeof(u32));
+    
+    GLuint prog = glCreateProgram();
+    glProgramBinary(prog, format, blob.data() + sizeof(u32), (GLsizei) (blob.size() - sizeof(u32)));
+
+    GLint success;
+    glGetProgramiv(prog, GL_LINK_STATUS, &success);
+    if (success == GL_FALSE) {
+        glDeleteProgram(prog);
+        return 0u;
+    }
+    return prog;
+}
+
 inline fn os_clear_color_gl(const Vec4& color) -> void {
     glClearColor(color.x, color.y, color.z, color.w);
 }
@@ -171,8 +253,15 @@ inline fn os_is_gl_attribute(Data_Type type) -> bool {
         case Data_Type::Int2:    
         case Data_Type::Int3:  
         case Data_Type::Int4: 
+        case Data_Type::Half2:
+        case Data_Type::Half4:
+        case Data_Type::UNorm8x4:
+        case Data_Type::SNorm16x2:
+        case Data_Type::SNorm16x4:
+        case Data_Type::SNorm1010102:
             return true;
         case Data_Type::Sampler2D:
+        case Data_Type::Sampler2DArray:
         case Data_Type::Bool:
         case Data_Type::None:
             return false;
@@ -193,6 +282,7 @@ inline fn os_from_gl(GLint type) -> Data_Type {
         case GL_INT_VEC3   : return Data_Type::Int3;
         case GL_INT_VEC4   : return Data_Type::Int4;
         case GL_SAMPLER_2D : return Data_Type::Sampler2D;
+        case GL_SAMPLER_2D_ARRAY : return Data_Type::Sampler2DArray;
         case GL_BOOL       : return Data_Type::Bool;
     }
     return Data_Type::None;
@@ -211,7 +301,14 @@ inline fn os_to_gl(Data_Type type) -> GLint {
         case Data_Type::Int3      : return GL_INT;
         case Data_Type::Int4      : return GL_INT;
         case Data_Type::Sampler2D : return GL_SAMPLER_2D;
+        case Data_Type::Sampler2DArray : return GL_SAMPLER_2D_ARRAY;
         case Data_Type::Bool      : return GL_BOOL;
+        case Data_Type::Half2     : return GL_HALF_FLOAT;
+        case Data_Type::Half4     : return GL_HALF_FLOAT;
+        case Data_Type::UNorm8x4  : return GL_UNSIGNED_BYTE;
+        case Data_Type::SNorm16x2 : return GL_SHORT;
+        case Data_Type::SNorm16x4 : return GL_SHORT;
+        case Data_Type::SNorm1010102 : return GL_INT_2_10_10_10_REV;
         case Data_Type::None      : return 0;
     }
     return 0;
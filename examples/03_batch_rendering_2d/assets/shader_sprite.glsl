@@ -1,6 +1,6 @@
 #ifdef VERTEX_SHADER
 
-layout(location = 0) in vec4 a_pos;
+layout(location = 0) in vec3 a_pos;
 layout(location = 1) in vec2 a_uv; 
 layout(location = 2) in vec4 a_tint;
 layout(location = 3) in int a_tex_unit;
@@ -14,7 +14,7 @@ out vec4 v_tint;
 out flat int v_tex_unit; 
 
 void main() {
-    gl_Position = u_projection * vec4(a_pos.x, a_pos.y, a_pos.z, a_pos.w);
+    gl_Position = u_projection * vec4(a_pos, 1.0);
 
     v_uv = a_uv; 
     v_tint = a_tint; 
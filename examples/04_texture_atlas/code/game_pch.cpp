@@ -0,0 +1 @@
+#include "game_pch.h"
\ No newline at end of file
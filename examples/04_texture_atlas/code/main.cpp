@@ -0,0 +1,61 @@
+#include "app.h"
+#include "draw.h"
+#include "graphics.h"
+
+fn main() -> s32 {
+
+    // 1. The survive2d sprites and sprite shader, no need for a copy here.
+    App_Desc desc;
+    desc.window.title = L"04 Texture Atlas";
+    desc.working_dir = "..\\..\\games\\survive2d\\assets";
+    app_init(desc);
+    draw_init();
+
+    // 2. The strips that go in the atlas. Each one is a 192 px tileset, 768 or 1152 px wide.
+    std::string_view sprite_files[] = {
+        "sprites/Units/Blue Units/Monk/Run.png",
+        "sprites/Units/Blue Units/Monk/Idle.png",
+        "sprites/Units/Blue Units/Warrior/Warrior_Run.png",
+        "sprites/Units/Blue Units/Warrior/Warrior_Guard.png",
+        "sprites/Units/Blue Units/Warrior/Warrior_Attack1.png",
+        "sprites/Units/Blue Units/Warrior/Warrior_Attack2.png",
+        "sprites/Units/Blue Units/Archer/Archer_Run.png",
+        "sprites/Units/Blue Units/Pawn/Pawn_Run.png",
+    };
+    constexpr s32 sprite_count = sizeof(sprite_files) / sizeof(sprite_files[0]);
+    Texture_Def sprites[sprite_count];
+    for (s32 i = 0; i < sprite_count; ++i) {
+        sprites[i].kind = Texture_Kind::Tileset;
+        sprites[i].tile_size = 192;
+        sprites[i].filename = sprite_files[i];
+    }
+
+    // 3. Pages smaller than the default on purpose: no two strips fit side by side and 6 fit one over the other,
+    // so the atlas takes 2 pages. The images on the first page must keep their place once the second is packed.
+    Atlas atlas;
+    Atlas_Def atlas_def;
+    atlas_def.images = sprites;
+    atlas_def.image_count = sprite_count;
+    atlas_def.page_size = 1280;
+    atlas_init(&atlas, atlas_def);
+    checkf(atlas.page_count > 1, "Error! The atlas should take more than one page!");
+
+    while (app_running()) {
+
+        clear_back_buffer();
+
+        // 4. The second frame of every strip, 4 per row. A view that lost its place shows the wrong unit.
+        draw_frame_init();
+        for (s32 i = 0; i < sprite_count; ++i) {
+            Vec3 pos = { -3.f + 2.f * (f32) (i % 4), 1.f - 2.f * (f32) (i / 4), 0.f };
+            draw_sprite(atlas_get(atlas, i), 1, Color.White, Mat4::transform(pos, F32.Zero, { 2.f, 2.f, 1.f }));
+        }
+        draw_frame_done();
+
+        os_swap_buffers();
+    }
+
+    atlas_done(&atlas);
+    draw_done();
+    app_done();
+}
@@ -245,6 +245,8 @@ fn main() -> s32 {
         glClear(GL_COLOR_BUFFER_BIT);
         
         // Draw.
+        draw_frame_init();
+
         if (gs.started) {
             draw_box(pL.box);
             draw_box(pR.box);
@@ -257,6 +259,8 @@ fn main() -> s32 {
 
         draw_box(ball.box);
 
+        draw_frame_done();
+
         // Draw the gui
         imgui_frame_init();
         {
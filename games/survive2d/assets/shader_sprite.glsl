@@ -1,15 +1,29 @@
 #ifdef VERTEX_SHADER
 
+#ifdef INSTANCED
+
+// Unit quad (per vertex).
 layout(location = 0) in vec2 a_pos;
 layout(location = 1) in vec2 a_uv;
 
+// Sprite (per instance).
+layout(location = 2) in vec4 a_basis;   // 2D affine: x axis (xy), y axis (zw).
+layout(location = 3) in vec3 a_origin;  // Translation, z is the depth.
+layout(location = 4) in vec4 a_uv_rect; // UV offset (xy), UV size (zw). Half floats.
+layout(location = 5) in vec4 a_tint;    // Normalized bytes.
+layout(location = 6) in int a_tex_unit;
+
+#else
+
+layout(location = 0) in vec3 a_pos;
+layout(location = 1) in vec2 a_uv;   // Half floats.
+layout(location = 2) in vec4 a_tint; // Normalized bytes.
+layout(location = 3) in int a_tex_unit;
+
+#endif
+
 layout(std140, binding = 0) uniform Shader_Data {
   mat4 u_projection;
-  mat4 u_transform;
-  vec2 u_uv_size;
-  vec2 u_uv_offset;
-  vec4 u_tint;
-  int u_tex_unit;
 };
 
 out vec2 v_uv;
@@ -17,27 +31,45 @@ out vec4 v_tint;
 out flat int v_tex_unit; 
 
 void main() {
-    gl_Position = u_projection * u_transform * vec4(a_pos.x, a_pos.y, 0.0, 1.0);
-    v_uv = a_uv * u_uv_size + u_uv_offset;
-    v_tex_unit = u_tex_unit;
-    v_tint = u_tint;
+#ifdef INSTANCED
+    vec2 pos = a_origin.xy + a_basis.xy * a_pos.x + a_basis.zw * a_pos.y;
+    gl_Position = u_projection * vec4(pos, a_origin.z, 1.0);
+    v_uv = a_uv * a_uv_rect.zw + a_uv_rect.xy;
+#else
+    gl_Position = u_projection * vec4(a_pos, 1.0);
+    v_uv = a_uv; 
+#endif
+    v_tint = a_tint; 
+    v_tex_unit = a_tex_unit;
 }
 #endif
 
 #ifdef FRAGMENT_SHADER
 
+// 1. Retrieve the data from the vertex.
 in vec2 v_uv;
-in flat int v_tex_unit; 
 in vec4 v_tint;
+in flat int v_tex_unit; 
 
 layout(location = 0) out vec4 o_col;
 
-#define MAX_TEXTURES 32
+#define MAX_TEXTURES 16
 
+// 2. The units [0, 16) are 2D textures, [16, 32) arrays. The layer goes in the upper bits.
 uniform sampler2D u_samplers[MAX_TEXTURES];
+uniform sampler2DArray u_array_samplers[MAX_TEXTURES];
 
 void main() {
-  o_col = v_tint * texture(u_samplers[v_tex_unit], v_uv);
+  int unit = v_tex_unit & 0xFF;
+  int layer = v_tex_unit >> 8;
+  vec4 col;
+  if (unit < MAX_TEXTURES) {
+    col = texture(u_samplers[unit], v_uv);
+  } else {
+    col = texture(u_array_samplers[unit - MAX_TEXTURES], vec3(v_uv, layer));
+  }
+  // 3. The textures come premultiplied (see ser_blend_enabled), the tint has to match.
+  o_col = col * vec4(v_tint.rgb * v_tint.a, v_tint.a);
 }
 
 #endif
\ No newline at end of file
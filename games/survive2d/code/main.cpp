@@ -37,30 +37,75 @@ fn main() -> s32 {
     desc.window.title = L"Survive 2D";
     app_init(desc);
     draw_init();
-    entity_storage_init();
+    Pool pool;
+    pool_init(&pool);
+    entity_storage_init(pool_allocator(&pool));
     
-    Texture tex;
-    Texture_Def def;
-    def.kind = Texture_Kind::Tileset;
-    def.tile_size = 192;
-    def.filename = "sprites/Units/Blue Units/Monk/Run.png";
-    texture_init(&tex, def);
+    Texture_Def sprites[2];
+    sprites[0].kind = Texture_Kind::Tileset;
+    sprites[0].tile_size = 192;
+    sprites[0].filename = "sprites/Units/Blue Units/Monk/Run.png";
+    sprites[1].kind = Texture_Kind::Tileset;
+    sprites[1].tile_size = 192;
+    sprites[1].filename = "sprites/Units/Blue Units/Monk/Idle.png";
+
+    Atlas atlas;
+    Atlas_Def atlas_def;
+    atlas_def.images = sprites;
+    atlas_def.image_count = 2;
+    atlas_init(&atlas, atlas_def);
+
+    // @Note: The whole pawn animation set under one bind. Idle takes the layers [0, 8), Run [8, 14).
+    std::string_view pawn_files[] = {
+        "sprites/Units/Blue Units/Pawn/Pawn_Idle.png",
+        "sprites/Units/Blue Units/Pawn/Pawn_Run.png",
+    };
+    Texture pawn;
+    Texture_Def pawn_def;
+    pawn_def.kind = Texture_Kind::Array;
+    pawn_def.tile_size = 192;
+    pawn_def.filenames = pawn_files;
+    pawn_def.filename_count = 2;
+    texture_init(&pawn, pawn_def);
+
+    // @Note: Streams in while the game runs, the archer shows up once its texture is there.
+    Texture archer;
+    Texture_Def archer_def;
+    archer_def.kind = Texture_Kind::Tileset;
+    archer_def.tile_size = 192;
+    archer_def.filename = "sprites/Units/Blue Units/Archer/Archer_Idle.png";
+    Texture_Async archer_load = texture_init_async(&archer, archer_def);
 
     Entity_Handle hA = entity_create(Entity_Kind_Player);
     Entity_Handle hB = entity_create(Entity_Kind_Player);
+    Entity_Handle hC = entity_create(Entity_Kind_Player);
+    Entity_Handle hD = entity_create(Entity_Kind_Player);
     
     Entity* entityA = entity_get(hA);
     Entity* entityB = entity_get(hB);
+    Entity* entityC = entity_get(hC);
+    Entity* entityD = entity_get(hD);
 
     entityA->scl = { 3.f, 3.f, 1.f };
-    entityA->tex = &tex;
+    entityA->tex = atlas_get(atlas, 0);
     entityA->sprite = 1;
 
     entityB->pos = Vec3(F32.Right) * 2.f;
     entityB->scl = { 3.f, 3.f, 1.f };
-    entityB->tex = &tex;
+    entityB->tex = atlas_get(atlas, 1);
     entityB->sprite = 1;
 
+    entityC->pos = Vec3(F32.Left) * 2.f;
+    entityC->scl = { 3.f, 3.f, 1.f };
+    entityC->tex = &pawn;
+    entityC->sprite = 8;
+
+    entityD->pos = Vec3(F32.Up) * 2.f;
+    entityD->scl = { 3.f, 3.f, 1.f };
+    entityD->tex = &archer;
+    entityD->sprite = 1;
+    entityD->visible = false;
+
     Serializer s;
     serialize(&s, *entityA);
 
@@ -71,13 +116,47 @@ fn main() -> s32 {
 
     while(app_running()) {
         
+        if (!entityD->visible && texture_poll(&archer_load)) {
+            entityD->visible = archer.tex != 0;
+        }
+
         clear_back_buffer();
+
+        draw_frame_init();
         entity_pass(draw_sprite_entity);
+        draw_frame_done();
+
+        imgui_frame_init();
+        if (imgui_is_init()) {
+            Draw_Stats stats = draw_stats();
+            ImGui::Begin("Debug");
+            ImGui::Text("FPS: %f", os_fps());
+            ImGui::Text("Sprites: %i", stats.sprites);
+            ImGui::Text("Flushes: %i", stats.flushes);
+            ImGui::Text("Draw Calls: %i", stats.draw_calls);
+            ImGui::Text("Bytes: %i", stats.bytes);
+            ImGui::Text("Stream Stalls: %i", stats.stalls);
+            ImGui::Text("GL Calls: %i (elided %i)", stats.gl_issued, stats.gl_elided);
+            ImGui::Text("Sort: %.3f ms", stats.sort_ms);
+            bool instanced = draw_path() == Draw_Path::Instanced;
+            if (ImGui::Checkbox("Instanced", &instanced)) {
+                draw_set_path(instanced ? Draw_Path::Instanced : Draw_Path::Batched);
+            }
+            ImGui::End();
+        }
+        imgui_frame_done();
+
         os_swap_buffers();
     }
 
-    texture_done(&tex);
+    texture_wait(&archer_load);
+    if (archer.tex != 0) {
+        texture_done(&archer);
+    }
+    texture_done(&pawn);
+    atlas_done(&atlas);
     entity_storage_done();
+    pool_done(&pool);
     draw_done();
     app_done();
 }
\ No newline at end of file
@@ -257,5 +257,13 @@ prj_lib "core"
 prj_game ("01_quads", "examples/01_quads") 
 prj_game ("02_textures", "examples/02_textures") 
 prj_game ("03_batch_rendering_2d", "examples/03_batch_rendering_2d") 
+prj_game ("04_texture_atlas", "examples/04_texture_atlas") 
 prj_game ("pong", "games/pong") 
-prj_game ("survive2d", "games/survive2d") 
\ No newline at end of file
+prj_game ("survive2d", "games/survive2d")
+
+---------------------------------------------
+------------------ TOOLS --------------------
+---------------------------------------------
+group "tools"
+
+prj_game ("cooker", "tools/cooker") 
\ No newline at end of file
@@ -0,0 +1,178 @@
+#include "base_jobs.h"
+#include "os_core.h"
+#include "io_image.h"
+#include "io_model.h"
+
+#include <stdio.h>
+#include <vector>
+
+// @Note: Cooks every .png (see io_image_cook) and .obj (see io_model_cook) under the given dirs, the survive2d
+// sprites by default. The ones already up to date are skipped, so it's cheap to run before every build.
+// The images are BC3 unless told otherwise (see io_bc.h): a quarter of the RGBA8 size, ~41 dB over the sprites.
+// BC1 is an eighth but ~34 dB, its alpha is 1 bit. BC7 (only mode 6 here) does worse than BC3 on them, ~37 dB, as
+// its 4 channels share the indices.
+// -verify decodes every cooked image and compares it with its source (see io_image_cooked_psnr): it prints the mean
+// PSNR per format and fails the levels below verify_floor.
+// Usage: cooker [-rgba8 | -bc1 | -bc3 | -bc7] [-verify] [dir...]
+
+static fn parse_format(std::string_view arg, IO_Image_Format* format) -> bool {
+    if      (arg == "-rgba8") *format = IO_Image_Format::RGBA8;
+    else if (arg == "-bc1")   *format = IO_Image_Format::BC1;
+    else if (arg == "-bc3")   *format = IO_Image_Format::BC3;
+    else if (arg == "-bc7")   *format = IO_Image_Format::BC7;
+    else return false;
+    return true;
+}
+
+// @Note: Lowest PSNR (dB) a level of 16x16 or more may have, a bit under the worst of the survive2d sprites. The
+// smaller levels are a few blocks of blurred edges, where the blocks do much worse (BC1 down to ~9 dB at 1x1).
+static fn verify_floor(IO_Image_Format format) -> f32 {
+    switch (format) {
+        case IO_Image_Format::BC1: return 16.f;
+        case IO_Image_Format::BC3: return 20.f;
+        case IO_Image_Format::BC7: return 18.f;
+        case IO_Image_Format::RGBA8:
+        default: return INFINITY;
+    }
+}
+
+static fn format_name(IO_Image_Format format) -> const char* {
+    switch (format) {
+        case IO_Image_Format::BC1: return "BC1";
+        case IO_Image_Format::BC3: return "BC3";
+        case IO_Image_Format::BC7: return "BC7";
+        case IO_Image_Format::RGBA8:
+        default: return "RGBA8";
+    }
+}
+
+// @Note: The images are already cooked. Returns how many failed.
+static fn verify(const std::vector<std::string>& images) -> s32 {
+    constexpr s32 format_count = (s32) IO_Image_Format::BC7 + 1;
+    std::vector<IO_Cooked_Psnr> results(images.size());
+    std::vector<u8> verified(images.size());
+    parallel_for((s32) images.size(), 1, [&](s32 first, s32 count) {
+        for (s32 i = first; i < first + count; ++i) {
+            verified[i] = io_image_cooked_psnr(images[i], &results[i]);
+        }
+    });
+
+    s32 failed = 0;
+    f64 sums[format_count] = {};
+    s32 counts[format_count] = {};
+    s32 exact[format_count] = {}; // Out of the mean, their PSNR is infinite.
+    for (u64 i = 0; i < images.size(); ++i) {
+        const IO_Cooked_Psnr& psnr = results[i];
+        if (!verified[i]) {
+            ++failed;
+            printf("Failed to verify: %s\n", images[i].c_str());
+            continue;
+        }
+        f32 floor = verify_floor(psnr.format);
+        for (s32 level = 0; level < psnr.level_count; ++level) {
+            if (std::min(psnr.widths[level], psnr.heights[level]) >= 16 && psnr.levels[level] < floor) {
+                ++failed;
+                printf("Low PSNR: %s level %i (%ix%i) %s %.1f dB, under %.1f dB\n", images[i].c_str(), level,
+                       psnr.widths[level], psnr.heights[level], format_name(psnr.format), psnr.levels[level], floor);
+                break;
+            }
+        }
+        if (std::isinf(psnr.chain)) {
+            ++exact[(s32) psnr.format];
+        } else {
+            sums[(s32) psnr.format] += psnr.chain;
+            ++counts[(s32) psnr.format];
+        }
+    }
+    for (s32 i = 0; i < format_count; ++i) {
+        if (counts[i] > 0 || exact[i] > 0) {
+            printf("%s: %i images, %.1f dB mean, %i exact.\n", format_name((IO_Image_Format) i), counts[i] + exact[i],
+                   counts[i] > 0 ? sums[i] / counts[i] : INFINITY, exact[i]);
+        }
+    }
+    return failed;
+}
+
+fn main(s32 argc, char** argv) -> s32 {
+    jobs_init();
+
+    IO_Image_Format format = IO_Image_Format::BC3;
+    bool verify_images = false;
+    std::vector<std::string> dirs;
+    for (s32 i = 1; i < argc; ++i) {
+        if (std::string_view(argv[i]) == "-verify") {
+            verify_images = true;
+        } else if (!parse_format(argv[i], &format)) {
+            dirs.push_back(argv[i]);
+        }
+    }
+    if (dirs.empty()) {
+        dirs.push_back("../../games/survive2d/assets/sprites");
+    }
+
+    std::vector<std::string> images;
+    std::vector<std::string> models;
+    for (const std::string& dir : dirs) {
+        os_walk_dir(dir, [&](std::string_view path) {
+            std::string extension = get_extension(path);
+            if (extension == ".png") {
+                images.emplace_back(path);
+            } else if (extension == ".obj") {
+                models.emplace_back(path);
+            }
+        });
+    }
+
+    f64 start = os_get_time();
+    std::atomic<s32> cooked = 0;
+    std::atomic<s32> up_to_date = 0;
+    std::atomic<s32> failed = 0;
+    parallel_for((s32) images.size(), 1, [&](s32 first, s32 count) {
+        for (s32 i = first; i < first + count; ++i) {
+            // @Note: The sizes the blocks can't take stay RGBA8, whatever the format.
+            IO_Cooked_Image image;
+            if (io_image_map_cooked(images[i], &image)) {
+                const IO_Image_Level& level = image.levels[0];
+                bool same_format = image.format == format || level.width % 4 != 0 || level.height % 4 != 0;
+                io_image_unmap_cooked(&image);
+                if (same_format) {
+                    ++up_to_date;
+                    continue;
+                }
+            }
+            if (io_image_cook(images[i], format)) {
+                ++cooked;
+            } else {
+                ++failed;
+                printf("Failed: %s\n", images[i].c_str());
+            }
+        }
+    });
+
+    // @Note: io_model_load cooks them when they're stale, the parse already runs on the job pool. A model that comes
+    // back mapped was up to date, else the cooked file has to be a new one.
+    for (const std::string& path : models) {
+        IO_Model model;
+        u64 cooked_time = os_get_file_time(io_model_cooked_path(path));
+        bool loaded = io_model_load(path, &model);
+        if (loaded && model.cooked.data) {
+            ++up_to_date;
+        } else if (loaded && os_get_file_time(io_model_cooked_path(path)) != cooked_time) {
+            ++cooked;
+        } else {
+            ++failed;
+            printf("Failed: %s\n", path.c_str());
+        }
+        io_model_free(&model);
+    }
+
+    if (verify_images) {
+        failed += verify(images);
+    }
+
+    printf("%i files: %i cooked, %i up to date, %i failed. %.2f s.\n",
+           (s32) (images.size() + models.size()), cooked.load(), up_to_date.load(), failed.load(), os_get_time() - start);
+
+    jobs_done();
+    return failed > 0 ? 1 : 0;
+}